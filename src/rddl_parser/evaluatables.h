@@ -54,6 +54,10 @@ struct Evaluatable {
     std::vector<double> precomputedResults;
     std::vector<DiscretePD> precomputedPDResults;
 
+    // If the caching type is LAZY_VECTOR, this is the size of the vector that
+    // is filled during search
+    long cachingVectorSize;
+
     // The kleene caching type that will be used (initially) for this
     // evaluatable and the size of the vector if kleeneCachingType is VECTOR
     std::string kleeneCachingType;
@@ -164,17 +164,32 @@ void HashKeyGenerator::prepareStateFluentHashKeys(Evaluatable* eval,
     }
 
     // At this point, hashKeyBase is equal to the number of perfect hash keys
-    // of eval. Depending on that number, we use a vector or a map for caching.
+    // of eval. Depending on that number, we use a precomputed vector, a vector
+    // that is filled lazily during search or a map for caching.
     // TODO: Make sure this arbitrarily chosen constant makes sense
-    if (hashKeyBase > 1000000) {
-        eval->cachingType = "MAP";
-    } else {
+    if (hashKeyBase <= 1000000) {
         eval->cachingType = "VECTOR";
         eval->precomputedResults.resize(hashKeyBase,
                                         -numeric_limits<double>::max());
         if (eval->isProbabilistic()) {
             eval->precomputedPDResults.resize(hashKeyBase);
         }
+    } else if (hashKeyBase <= maxLazyVectorSize) {
+        long numberOfBytes = hashKeyBase;
+        unsigned long bytesPerKey = sizeof(double);
+        if (eval->isProbabilistic()) {
+            bytesPerKey += sizeof(DiscretePD);
+        }
+        if (utils::multiplyWithOverflowCheck(numberOfBytes, bytesPerKey) &&
+            (numberOfBytes <= remainingLazyVectorBytes)) {
+            eval->cachingType = "LAZY_VECTOR";
+            eval->cachingVectorSize = hashKeyBase;
+            remainingLazyVectorBytes -= numberOfBytes;
+        } else {
+            eval->cachingType = "MAP";
+        }
+    } else {
+        eval->cachingType = "MAP";
     }
 }
 
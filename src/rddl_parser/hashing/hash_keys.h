@@ -45,6 +45,15 @@
      equivalence class is then assigned a value in the domain.
 
   4. Akin to 3., we compute the same kind of hash keys for Kleene evaluation.
+
+  The number of perfect hash keys of an Evaluatable determines how its results
+  are cached in search: if there are only few, all results are precomputed and
+  stored in a vector (VECTOR). If there are too many for precomputation but not
+  more than maxLazyVectorSize, search uses a vector of the same layout that is
+  filled on demand (LAZY_VECTOR), and otherwise a hash map (MAP). As search
+  allocates these vectors in full, the memory of all of them is bounded by
+  maxLazyVectorBytes, and Evaluatables that exceed the remaining budget are
+  cached in a map as well.
 */
 
 #include <vector>
@@ -57,13 +66,27 @@ struct RDDLTask;
 namespace hashing {
 class HashKeyGenerator {
 public:
-    HashKeyGenerator(RDDLTask* task) : task(task) {}
+    HashKeyGenerator(RDDLTask* task, long maxLazyVectorSize = 5000000,
+                     long maxLazyVectorBytes = 536870912)
+        : task(task),
+          maxLazyVectorSize(maxLazyVectorSize),
+          remainingLazyVectorBytes(maxLazyVectorBytes) {}
 
     void generateHashKeys(bool output = true);
 
 private:
     RDDLTask* task;
 
+    // The maximal number of hash keys of an Evaluatable with caching type
+    // LAZY_VECTOR (Evaluatables with more hash keys are cached in a map)
+    long maxLazyVectorSize;
+
+    // The number of bytes that is still available for the vectors of
+    // Evaluatables with caching type LAZY_VECTOR. Each hash key takes the
+    // space of a double and, if the Evaluatable is probabilistic, of a
+    // DiscretePD.
+    long remainingLazyVectorBytes;
+
     /*
       Determines if it is possible to compute perfect state hash keys. If state
       hashing is possible,  all summands of hash(s) (i.e., base(v_i) * d_1,
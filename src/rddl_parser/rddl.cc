@@ -444,6 +444,9 @@ void RDDLTask::print(ostream& out) {
                 out << res << " " << CPFs[index]->precomputedResults[res]
                     << endl;
             }
+        } else if (CPFs[index]->cachingType == "LAZY_VECTOR") {
+            out << "## caching vec size" << endl;
+            out << CPFs[index]->cachingVectorSize << endl;
         }
         out << "## kleene caching type" << endl;
         out << CPFs[index]->kleeneCachingType << endl;
@@ -515,6 +518,9 @@ void RDDLTask::print(ostream& out) {
                 }
                 out << endl;
             }
+        } else if (CPFs[index]->cachingType == "LAZY_VECTOR") {
+            out << "## caching vec size" << endl;
+            out << CPFs[index]->cachingVectorSize << endl;
         }
         out << "## kleene caching type" << endl;
         out << CPFs[index]->kleeneCachingType << endl;
@@ -555,6 +561,9 @@ void RDDLTask::print(ostream& out) {
              ++res) {
             out << res << " " << rewardCPF->precomputedResults[res] << endl;
         }
+    } else if (rewardCPF->cachingType == "LAZY_VECTOR") {
+        out << "## caching vec size" << endl;
+        out << rewardCPF->cachingVectorSize << endl;
     }
     out << "## kleene caching type" << endl;
     out << rewardCPF->kleeneCachingType << endl;
@@ -591,6 +600,9 @@ void RDDLTask::print(ostream& out) {
                 out << res << " " << preconds[index]->precomputedResults[res]
                     << endl;
             }
+        } else if (preconds[index]->cachingType == "LAZY_VECTOR") {
+            out << "## caching vec size" << endl;
+            out << preconds[index]->cachingVectorSize << endl;
         }
         out << "## kleene caching type" << endl;
         out << preconds[index]->kleeneCachingType << endl;
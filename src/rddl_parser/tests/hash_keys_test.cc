@@ -215,5 +215,53 @@ TEST_CASE("Hash key generation") {
         CHECK(task->indexToStateFluentHashKeyMap[2][0].first == 2);
         CHECK(task->indexToStateFluentHashKeyMap[2][0].second == 32);
     }
+
+    SUBCASE("Caching types of evaluatables") {
+        // There are 2^21 perfect hash keys for a CPF that depends on 21 binary
+        // state fluents, which is too many to precompute all results
+        task->actionStates = {a000};
+        int numVars = 21;
+        for (int i = 0; i < numVars; ++i) {
+            auto var = new StateFluent(*pVar, params, 0.0, i);
+            auto cpf = new ConditionalProbabilityFunction(var, nullptr);
+            cpf->setDomainSize(2);
+            task->stateFluents.push_back(var);
+            task->CPFs.push_back(cpf);
+        }
+        task->CPFs[0]->dependentStateFluents.insert(
+            task->stateFluents.begin(), task->stateFluents.end());
+        task->CPFs[1]->dependentStateFluents = {task->stateFluents[0]};
+
+        SUBCASE("Lazily filled vector") {
+            HashKeyGenerator h(task);
+            h.generateHashKeys(false);
+            CHECK(task->CPFs[0]->cachingType == "LAZY_VECTOR");
+            CHECK(task->CPFs[0]->cachingVectorSize == 2097152);
+            CHECK(task->CPFs[0]->precomputedResults.empty());
+            CHECK(task->CPFs[1]->cachingType == "VECTOR");
+            CHECK(task->CPFs[1]->precomputedResults.size() == 2);
+        }
+
+        SUBCASE("Map if lazily filled vector is too large") {
+            HashKeyGenerator h(task, 2000000);
+            h.generateHashKeys(false);
+            CHECK(task->CPFs[0]->cachingType == "MAP");
+            CHECK(task->CPFs[1]->cachingType == "VECTOR");
+        }
+
+        SUBCASE("Lazily filled vector if it fits into memory") {
+            // The vector of the deterministic CPF needs 2^21 * 8 bytes
+            HashKeyGenerator h(task, 5000000, 16777216);
+            h.generateHashKeys(false);
+            CHECK(task->CPFs[0]->cachingType == "LAZY_VECTOR");
+        }
+
+        SUBCASE("Map if memory of lazily filled vectors is exhausted") {
+            HashKeyGenerator h(task, 5000000, 16777215);
+            h.generateHashKeys(false);
+            CHECK(task->CPFs[0]->cachingType == "MAP");
+            CHECK(task->CPFs[1]->cachingType == "VECTOR");
+        }
+    }
 }
 } // namespace prost::parser::hashing
\ No newline at end of file
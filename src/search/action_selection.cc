@@ -102,6 +102,12 @@ int ActionSelection::selectAction(SearchNode* node) {
         _selectAction(node);
     }
 
+    // If several threads search in the same tree, all children might have
+    // been solved by other threads since this node was reached
+    if (bestActionIndices.empty()) {
+        selectGreedyAction(node);
+    }
+
     // Pick one of the candidates uniformly at random
     assert(!bestActionIndices.empty());
     int selectedIndex = MathUtils::rnd->randomElement(bestActionIndices);
@@ -241,9 +247,24 @@ void UCB1ActionSelection::_selectAction(SearchNode* node) {
         SearchNode* child = node->children[index];
         if (child && child->initialized && !child->solved) {
             double childNumVisits = static_cast<double>(child->numberOfVisits);
+            double childReward = child->getExpectedRewardEstimate();
+
+            // Each thread that currently performs a trial below child is
+            // treated as an additional visit with minimal reward (virtual
+            // loss), such that simultaneous trials diversify
+            int virtualLoss = child->virtualLoss;
+            if (virtualLoss > 0) {
+                double lossReward =
+                    SearchEngine::rewardCPF->getMinVal() * child->stepsToGo;
+                childReward = (childNumVisits * childReward +
+                               virtualLoss * lossReward) /
+                              (childNumVisits + virtualLoss);
+                childNumVisits += virtualLoss;
+            }
+
             double visitPart =
                 magicConstant * sqrt(parentVisitPart / childNumVisits);
-            double UCTValue = child->getExpectedRewardEstimate() + visitPart;
+            double UCTValue = childReward + visitPart;
 
             assert(!MathUtils::doubleIsMinusInfinity(UCTValue));
 
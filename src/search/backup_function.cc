@@ -81,26 +81,29 @@ void BackupFunction::backupDecisionNode(SearchNode* node) {
 
     double oldFutureReward = node->futureReward;
 
-    // Propagate values from best child
-    node->futureReward = -std::numeric_limits<double>::max();
-    node->solved = useSolveLabeling;
+    // Propagate values from best child (the result is computed locally and
+    // stored at once, as other threads might read the node meanwhile)
+    double futureReward = -std::numeric_limits<double>::max();
+    bool solved = useSolveLabeling;
     for (SearchNode* child : node->children) {
         if (child) {
             if (child->initialized) {
-                node->solved &= child->solved;
-                node->futureReward = std::max(
-                    node->futureReward, child->getExpectedRewardEstimate());
+                solved &= child->solved;
+                futureReward =
+                    std::max(futureReward, child->getExpectedRewardEstimate());
             } else {
-                node->solved = false;
+                solved = false;
             }
         }
     }
+    node->futureReward = futureReward;
+    node->solved = solved;
 
     // If the future reward did not change we did not find a better node and
     // therefore do not need to update the rewards in preceding parents.
-    if (!node->solved &&
+    if (!solved &&
         (node->stepsToGo > thts->getTipNodeOfTrial()->stepsToGo) &&
-        MathUtils::doubleIsEqual(oldFutureReward, node->futureReward)) {
+        MathUtils::doubleIsEqual(oldFutureReward, futureReward)) {
         lockBackup = useBackupLock;
     }
 
@@ -129,12 +132,12 @@ bool MCBackupFunction::setValueFromString(std::string& param,
 
 void MCBackupFunction::backupChanceNode(SearchNode* node,
                                         double const& futReward) {
-    ++node->numberOfVisits;
+    int numberOfVisits = ++node->numberOfVisits;
+    double futureReward = node->futureReward;
 
     node->futureReward =
-        node->futureReward +
-        initialLearningRate * (futReward - node->futureReward) /
-            (1.0 + (learningRateDecay * (double)node->numberOfVisits));
+        futureReward + initialLearningRate * (futReward - futureReward) /
+                           (1.0 + (learningRateDecay * (double)numberOfVisits));
 
     // Logger::logLine("updated chance node:", Verbosity::DEBUG);
     // Logger::logLine(node->toString(), Verbosity::DEBUG);
@@ -149,19 +152,19 @@ void MaxMCBackupFunction::backupChanceNode(SearchNode* node,
     assert(MathUtils::doubleIsEqual(node->immediateReward, 0.0));
 
     ++node->numberOfVisits;
-    node->futureReward = 0.0;
+    double futureReward = 0.0;
     int numberOfChildVisits = 0;
 
     // Propagate values from children
     for (SearchNode* child : node->children) {
         if (child) {
-            node->futureReward +=
-                (child->numberOfVisits * child->getExpectedRewardEstimate());
-            numberOfChildVisits += child->numberOfVisits;
+            int childVisits = child->numberOfVisits;
+            futureReward += (childVisits * child->getExpectedRewardEstimate());
+            numberOfChildVisits += childVisits;
         }
     }
 
-    node->futureReward /= numberOfChildVisits;
+    node->futureReward = futureReward / numberOfChildVisits;
 
     // Logger::logLine("updated chance node:", Verbosity::DEBUG);
     // Logger::logLine(node->toString(), Verbosity::DEBUG);
@@ -182,14 +185,15 @@ void PBBackupFunction::backupChanceNode(SearchNode* node,
     }
 
     // Propagate values from children
-    node->futureReward = 0.0;
+    double futureReward = 0.0;
     double solvedSum = 0.0;
     double probSum = 0.0;
 
     for (SearchNode* child : node->children) {
-        if (child) {
-            node->futureReward +=
-                (child->prob * child->getExpectedRewardEstimate());
+        // A child that has neither been initialized nor visited waits for its
+        // initialization (in another thread or in a batch) and has no estimate
+        if (child && (child->initialized || (child->numberOfVisits > 0))) {
+            futureReward += (child->prob * child->getExpectedRewardEstimate());
             probSum += child->prob;
 
             if (child->solved) {
@@ -198,7 +202,9 @@ void PBBackupFunction::backupChanceNode(SearchNode* node,
         }
     }
 
-    node->futureReward /= probSum;
+    if (MathUtils::doubleIsGreater(probSum, 0.0)) {
+        node->futureReward = futureReward / probSum;
+    }
     node->solved = MathUtils::doubleIsEqual(solvedSum, 1.0);
 
     // Logger::logLine("updated chance node:", Verbosity::DEBUG);
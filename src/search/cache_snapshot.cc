@@ -0,0 +1,346 @@
+#include "cache_snapshot.h"
+
+#include "search_engine.h"
+
+#include "utils/logger.h"
+#include "utils/system_utils.h"
+
+#include <fstream>
+
+using namespace std;
+
+namespace {
+// Identifies a file as a cache snapshot (and the version of the format)
+long const snapshotFormatVersion = 1;
+
+template <typename T>
+inline void write(ofstream& out, T const& value) {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template <typename T>
+inline bool read(ifstream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return static_cast<bool>(in);
+}
+
+/*****************************************************************
+                         Evaluatable caches
+*****************************************************************/
+
+void writeCache(ofstream& out, DeterministicEvaluatable const* eval) {
+    long numberOfEntries = 0;
+    switch (eval->cachingType) {
+    case Evaluatable::MAP:
+    case Evaluatable::DISABLED_MAP:
+        numberOfEntries = eval->evaluationCacheMap.size();
+        write(out, numberOfEntries);
+        for (auto const& entry : eval->evaluationCacheMap) {
+            write(out, entry.first);
+            write(out, entry.second);
+        }
+        break;
+    case Evaluatable::LAZY_VECTOR:
+        for (double const& res : eval->evaluationCacheVector) {
+            if (!MathUtils::doubleIsMinusInfinity(res)) {
+                ++numberOfEntries;
+            }
+        }
+        write(out, numberOfEntries);
+        for (long key = 0; key < eval->evaluationCacheVector.size(); ++key) {
+            if (!MathUtils::doubleIsMinusInfinity(
+                    eval->evaluationCacheVector[key])) {
+                write(out, key);
+                write(out, eval->evaluationCacheVector[key]);
+            }
+        }
+        break;
+    case Evaluatable::NONE:
+    case Evaluatable::VECTOR:
+        write(out, numberOfEntries);
+        break;
+    }
+}
+
+void writePD(ofstream& out, DiscretePD const& pd) {
+    long size = pd.values.size();
+    write(out, size);
+    for (size_t i = 0; i < pd.values.size(); ++i) {
+        write(out, pd.values[i]);
+        write(out, pd.probabilities[i]);
+    }
+}
+
+void writeCache(ofstream& out, ProbabilisticEvaluatable const* eval) {
+    long numberOfEntries = 0;
+    switch (eval->cachingType) {
+    case Evaluatable::MAP:
+    case Evaluatable::DISABLED_MAP:
+        numberOfEntries = eval->evaluationCacheMap.size();
+        write(out, numberOfEntries);
+        for (auto const& entry : eval->evaluationCacheMap) {
+            write(out, entry.first);
+            writePD(out, entry.second);
+        }
+        break;
+    case Evaluatable::LAZY_VECTOR:
+        for (DiscretePD const& res : eval->evaluationCacheVector) {
+            if (!res.isUndefined()) {
+                ++numberOfEntries;
+            }
+        }
+        write(out, numberOfEntries);
+        for (long key = 0; key < eval->evaluationCacheVector.size(); ++key) {
+            if (!eval->evaluationCacheVector[key].isUndefined()) {
+                write(out, key);
+                writePD(out, eval->evaluationCacheVector[key]);
+            }
+        }
+        break;
+    case Evaluatable::NONE:
+    case Evaluatable::VECTOR:
+        write(out, numberOfEntries);
+        break;
+    }
+}
+
+bool readCache(ifstream& in, DeterministicEvaluatable* eval) {
+    long numberOfEntries;
+    if (!read(in, numberOfEntries)) {
+        return false;
+    }
+    for (long i = 0; i < numberOfEntries; ++i) {
+        long key;
+        double res;
+        if (!read(in, key) || !read(in, res)) {
+            return false;
+        }
+        if (eval->cachingType == Evaluatable::MAP) {
+            eval->evaluationCacheMap[key] = res;
+        } else if ((eval->cachingType == Evaluatable::LAZY_VECTOR) &&
+                   (key < eval->evaluationCacheVector.size())) {
+            eval->evaluationCacheVector[key] = res;
+        }
+    }
+    return true;
+}
+
+// A distribution has at least one and at most domainSize values, and any
+// other size read from the file means that the snapshot is corrupted
+bool readPD(ifstream& in, DiscretePD& pd, long domainSize) {
+    long size;
+    if (!read(in, size) || (size <= 0) || (size > domainSize)) {
+        return false;
+    }
+    pd.values.resize(size);
+    pd.probabilities.resize(size);
+    for (long i = 0; i < size; ++i) {
+        if (!read(in, pd.values[i]) || !read(in, pd.probabilities[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readCache(ifstream& in, ProbabilisticEvaluatable* eval) {
+    long numberOfEntries;
+    if (!read(in, numberOfEntries)) {
+        return false;
+    }
+    for (long i = 0; i < numberOfEntries; ++i) {
+        long key;
+        DiscretePD res;
+        if (!read(in, key) || !readPD(in, res, eval->getDomainSize())) {
+            return false;
+        }
+        assert(res.isWellDefined());
+        if (eval->cachingType == Evaluatable::MAP) {
+            eval->evaluationCacheMap[key] = res;
+        } else if ((eval->cachingType == Evaluatable::LAZY_VECTOR) &&
+                   (key < eval->evaluationCacheVector.size())) {
+            eval->evaluationCacheVector[key] = res;
+        }
+    }
+    return true;
+}
+
+/*****************************************************************
+                      State based caches
+*****************************************************************/
+
+void writeState(ofstream& out, State const& state) {
+    for (int i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
+        write(out, state.deterministicStateFluent(i));
+    }
+    for (int i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
+        write(out, state.probabilisticStateFluent(i));
+    }
+    write(out, state.stepsToGo());
+}
+
+bool readState(ifstream& in, State& state) {
+    for (int i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
+        if (!read(in, state.deterministicStateFluent(i))) {
+            return false;
+        }
+    }
+    for (int i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
+        if (!read(in, state.probabilisticStateFluent(i))) {
+            return false;
+        }
+    }
+    if (!read(in, state.stepsToGo())) {
+        return false;
+    }
+    State::calcStateFluentHashKeys(state);
+    State::calcStateHashKey(state);
+    return true;
+}
+
+void writeCache(ofstream& out, SearchEngine::StateValueHashMap const& cache) {
+    long numberOfEntries = cache.size();
+    write(out, numberOfEntries);
+    for (auto const& entry : cache) {
+        writeState(out, entry.first);
+        write(out, entry.second);
+    }
+}
+
+void writeCache(ofstream& out, SearchEngine::ActionHashMap const& cache) {
+    long numberOfEntries = cache.size();
+    write(out, numberOfEntries);
+    for (auto const& entry : cache) {
+        writeState(out, entry.first);
+        assert(entry.second.size() == SearchEngine::numberOfActions);
+        for (int actionIndex : entry.second) {
+            write(out, actionIndex);
+        }
+    }
+}
+
+bool readCache(ifstream& in, SearchEngine::StateValueHashMap& cache) {
+    long numberOfEntries;
+    if (!read(in, numberOfEntries)) {
+        return false;
+    }
+    for (long i = 0; i < numberOfEntries; ++i) {
+        State state;
+        double value;
+        if (!readState(in, state) || !read(in, value)) {
+            return false;
+        }
+        cache[state] = value;
+    }
+    return true;
+}
+
+bool readCache(ifstream& in, SearchEngine::ActionHashMap& cache) {
+    long numberOfEntries;
+    if (!read(in, numberOfEntries)) {
+        return false;
+    }
+    for (long i = 0; i < numberOfEntries; ++i) {
+        State state;
+        vector<int> applicableActions(SearchEngine::numberOfActions);
+        if (!readState(in, state)) {
+            return false;
+        }
+        for (int& actionIndex : applicableActions) {
+            if (!read(in, actionIndex)) {
+                return false;
+            }
+        }
+        cache[state] = applicableActions;
+    }
+    return true;
+}
+} // namespace
+
+/*****************************************************************
+                         Load and save
+*****************************************************************/
+
+bool CacheSnapshot::load(string const& file) {
+    ifstream in(file.c_str(), ios::binary);
+    if (!in) {
+        Logger::logLine("No cache snapshot found in " + file,
+                        Verbosity::NORMAL);
+        return false;
+    }
+
+    long version;
+    size_t taskHash;
+    if (!read(in, version) || (version != snapshotFormatVersion) ||
+        !read(in, taskHash) || (taskHash != SearchEngine::taskHash)) {
+        Logger::logLine("Ignoring cache snapshot in " + file +
+                        " as it was created for a different task",
+                        Verbosity::NORMAL);
+        return false;
+    }
+
+    // The order in which the caches are read must match the order in save()
+    bool success = true;
+    for (DeterministicCPF* cpf : SearchEngine::deterministicCPFs) {
+        success = success && readCache(in, cpf);
+    }
+    for (ProbabilisticCPF* cpf : SearchEngine::probabilisticCPFs) {
+        success = success && readCache(in, cpf);
+    }
+    for (DeterministicCPF* cpf : SearchEngine::determinizedCPFs) {
+        success = success && readCache(in, cpf);
+    }
+    success = success && readCache(in, SearchEngine::rewardCPF);
+    for (DeterministicEvaluatable* precond : SearchEngine::actionPreconditions) {
+        success = success && readCache(in, precond);
+    }
+
+    success =
+        success &&
+        readCache(in, ProbabilisticSearchEngine::applicableActionsCache) &&
+        readCache(in, DeterministicSearchEngine::applicableActionsCache) &&
+        readCache(in, ProbabilisticSearchEngine::stateValueCache) &&
+        readCache(in, DeterministicSearchEngine::stateValueCache);
+
+    if (!success) {
+        SystemUtils::abort("Error: cache snapshot in " + file +
+                           " is corrupted");
+    }
+
+    Logger::logLine("Loaded cache snapshot from " + file, Verbosity::NORMAL);
+    return true;
+}
+
+void CacheSnapshot::save(string const& file) {
+    ofstream out(file.c_str(), ios::binary | ios::trunc);
+    if (!out) {
+        Logger::logLine("Unable to write cache snapshot to " + file,
+                        Verbosity::SILENT);
+        return;
+    }
+
+    write(out, snapshotFormatVersion);
+    write(out, SearchEngine::taskHash);
+
+    for (DeterministicCPF const* cpf : SearchEngine::deterministicCPFs) {
+        writeCache(out, cpf);
+    }
+    for (ProbabilisticCPF const* cpf : SearchEngine::probabilisticCPFs) {
+        writeCache(out, cpf);
+    }
+    for (DeterministicCPF const* cpf : SearchEngine::determinizedCPFs) {
+        writeCache(out, cpf);
+    }
+    writeCache(out, SearchEngine::rewardCPF);
+    for (DeterministicEvaluatable const* precond :
+         SearchEngine::actionPreconditions) {
+        writeCache(out, precond);
+    }
+
+    writeCache(out, ProbabilisticSearchEngine::applicableActionsCache);
+    writeCache(out, DeterministicSearchEngine::applicableActionsCache);
+    writeCache(out, ProbabilisticSearchEngine::stateValueCache);
+    writeCache(out, DeterministicSearchEngine::stateValueCache);
+    out.close();
+
+    Logger::logLine("Saved cache snapshot to " + file, Verbosity::NORMAL);
+}
@@ -0,0 +1,31 @@
+#ifndef CACHE_SNAPSHOT_H
+#define CACHE_SNAPSHOT_H
+
+// A cache snapshot stores the content of the caches that do not depend on a
+// specific search engine configuration in a binary file, such that later runs
+// of the planner on the same parser output can start with warm caches. These
+// are the caches of all evaluatables that cache in a map or in a lazily filled
+// vector, the caches of applicable actions and the caches of state values of
+// solved states. Each snapshot is tagged with a hash of the parser output, and
+// a snapshot with a different tag is ignored.
+//
+// The file consists of fixed-size binary records in the native byte order,
+// i.e., a snapshot can only be read on the kind of machine where it was
+// created.
+
+#include <string>
+
+class CacheSnapshot {
+public:
+    // Fills the caches with the content of the snapshot in file. Returns false
+    // if there is no snapshot for the current task in file.
+    static bool load(std::string const& file);
+
+    // Writes the current content of all caches to file
+    static void save(std::string const& file);
+
+private:
+    CacheSnapshot() {}
+};
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "utils/math_utils.h"
 
+#include <algorithm>
 #include <iostream>
 #include <set>
 #include <logger.h>
@@ -15,7 +16,29 @@ using namespace std;
 ******************************************************************/
 
 DepthFirstSearch::DepthFirstSearch()
-    : DeterministicSearchEngine("DFS"), rewardHelperVar(0.0) {}
+    : DeterministicSearchEngine("DFS"),
+      numberOfDuplicateStates(0),
+      boundedSearch(false),
+      numberOfPrunedActions(0),
+      numberOfThreads(1),
+      rootState(nullptr),
+      rootQValues(nullptr),
+      nextRootAction(0),
+      jobCounter(0),
+      jobIsOpen(false),
+      busyThreads(0),
+      terminateThreads(false) {}
+
+DepthFirstSearch::~DepthFirstSearch() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        terminateThreads = true;
+    }
+    jobStarted.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
 
 /******************************************************************
                        Main Search Functions
@@ -36,6 +59,11 @@ void DepthFirstSearch::estimateQValues(State const& state,
     assert(state.stepsToGo() <= maxSearchDepth);
     assert(qValues.size() == SearchEngine::numberOfActions);
 
+    if (numberOfThreads > 1) {
+        estimateQValuesInParallel(state, actionsToExpand, qValues);
+        return;
+    }
+
     for (unsigned int index = 0; index < qValues.size(); ++index) {
         if (actionsToExpand[index] == index) {
             applyAction(state, index, qValues[index]);
@@ -43,6 +71,92 @@ void DepthFirstSearch::estimateQValues(State const& state,
     }
 }
 
+void DepthFirstSearch::resetExpandedStates() {
+    if (!expandedStates.empty()) {
+        StateValueHashMap tmp;
+        expandedStates.swap(tmp);
+    }
+}
+
+void DepthFirstSearch::estimateQValuesInParallel(
+    State const& state, vector<int> const& actionsToExpand,
+    vector<double>& qValues) {
+    if (threads.empty()) {
+        for (int i = 1; i < numberOfThreads; ++i) {
+            threads.emplace_back(&DepthFirstSearch::runThread, this);
+        }
+    }
+
+    // The caches that are shared among all search engines must be locked
+    // while more than one thread is running (unless this DFS is already used
+    // by one of several threads, which must not change the flag)
+    bool parallelSearchBefore = CacheLock::parallelSearch;
+    if (!parallelSearchBefore) {
+        CacheLock::parallelSearch = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        rootState = &state;
+        rootQValues = &qValues;
+        rootActionIndices.clear();
+        for (unsigned int index = 0; index < qValues.size(); ++index) {
+            if (actionsToExpand[index] == index) {
+                rootActionIndices.push_back(index);
+            }
+        }
+        nextRootAction = 0;
+        ++jobCounter;
+        jobIsOpen = true;
+    }
+    jobStarted.notify_all();
+
+    evaluateRootActions();
+
+    {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        jobIsOpen = false;
+        jobFinished.wait(lock, [this]() { return busyThreads == 0; });
+    }
+    if (!parallelSearchBefore) {
+        CacheLock::parallelSearch = false;
+    }
+}
+
+void DepthFirstSearch::evaluateRootActions() {
+    int numberOfRootActions = rootActionIndices.size();
+    for (int i = nextRootAction++; i < numberOfRootActions;
+         i = nextRootAction++) {
+        int actionIndex = rootActionIndices[i];
+        applyAction(*rootState, actionIndex, (*rootQValues)[actionIndex]);
+    }
+}
+
+void DepthFirstSearch::runThread() {
+    long lastJob = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobStarted.wait(lock, [this, lastJob]() {
+                return terminateThreads || (jobIsOpen && (jobCounter != lastJob));
+            });
+            if (terminateThreads) {
+                return;
+            }
+            lastJob = jobCounter;
+            ++busyThreads;
+        }
+
+        evaluateRootActions();
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            --busyThreads;
+        }
+        jobFinished.notify_one();
+    }
+}
+
 void DepthFirstSearch::applyAction(State const& state, int const& actionIndex,
                                    double& reward) {
     State nxt(state.stepsToGo() - 1);
@@ -51,17 +165,35 @@ void DepthFirstSearch::applyAction(State const& state, int const& actionIndex,
     // Logger::logLine(nxt.toString(), Verbosity::DEBUG);
     // Logger::logLine("reward: " + to_string(reward), Verbosity::DEBUG);
 
+    evaluateSuccessor(nxt, reward);
+}
+
+void DepthFirstSearch::evaluateSuccessor(State const& nxt, double& reward) {
     // Check if the next state is already cached
-    if (DeterministicSearchEngine::stateValueCache.find(nxt) !=
-        DeterministicSearchEngine::stateValueCache.end()) {
-        reward += DeterministicSearchEngine::stateValueCache[nxt];
-        return;
+    {
+        CacheLock lock(DeterministicSearchEngine::cacheMutex);
+        StateValueHashMap::const_iterator it =
+            DeterministicSearchEngine::stateValueCache.find(nxt);
+        if (it != DeterministicSearchEngine::stateValueCache.end()) {
+            reward += it->second;
+            return;
+        }
+    }
+    if (!cachingEnabled) {
+        CacheLock lock(expandedStatesMutex);
+        StateValueHashMap::const_iterator it = expandedStates.find(nxt);
+        if (it != expandedStates.end()) {
+            reward += it->second;
+            ++numberOfDuplicateStates;
+            return;
+        }
     }
 
     // Check if we have reached a leaf
     if (nxt.stepsToGo() == 1) {
-        calcOptimalFinalReward(nxt, rewardHelperVar);
-        reward += rewardHelperVar;
+        double finalReward = 0.0;
+        calcOptimalFinalReward(nxt, finalReward);
+        reward += finalReward;
         return;
     }
 
@@ -72,7 +204,7 @@ void DepthFirstSearch::applyAction(State const& state, int const& actionIndex,
 }
 
 void DepthFirstSearch::expandState(State const& state, double& result) {
-    assert(!cachingEnabled ||
+    assert(!cachingEnabled || CacheLock::parallelSearch ||
            (DeterministicSearchEngine::stateValueCache.find(state) ==
             DeterministicSearchEngine::stateValueCache.end()));
     assert(MathUtils::doubleIsMinusInfinity(result));
@@ -81,16 +213,62 @@ void DepthFirstSearch::expandState(State const& state, double& result) {
     vector<int> actionsToExpand = getApplicableActions(state);
 
     // Apply applicable actions and determine best one
-    for (unsigned int index = 0; index < actionsToExpand.size(); ++index) {
-        if (actionsToExpand[index] == index) {
-            double tmp = 0.0;
-            applyAction(state, index, tmp);
-            result = std::max(result, tmp);
+    if (boundedSearch) {
+        expandStateWithBounds(state, actionsToExpand, result);
+    } else {
+        for (unsigned int index = 0; index < actionsToExpand.size(); ++index) {
+            if (actionsToExpand[index] == index) {
+                double tmp = 0.0;
+                applyAction(state, index, tmp);
+                result = std::max(result, tmp);
+            }
         }
     }
 
     // Cache state value if caching is enabled
     if (cachingEnabled) {
+        CacheLock lock(DeterministicSearchEngine::cacheMutex);
         DeterministicSearchEngine::stateValueCache[state] = result;
+    } else {
+        CacheLock lock(expandedStatesMutex);
+        if (expandedStates.size() < maxNumberOfExpandedStates) {
+            expandedStates[state] = result;
+        }
+    }
+}
+
+void DepthFirstSearch::expandStateWithBounds(
+    State const& state, vector<int> const& actionsToExpand, double& result) {
+    // Compute all successors and order them by immediate reward, such that the
+    // best action found so far is a good bound early on
+    vector<State> successors;
+    vector<pair<double, int>> rewards;
+    for (unsigned int index = 0; index < actionsToExpand.size(); ++index) {
+        if (actionsToExpand[index] == index) {
+            successors.emplace_back(state.stepsToGo() - 1);
+            double reward = 0.0;
+            calcStateTransition(state, index, successors.back(), reward);
+            rewards.push_back(make_pair(reward, successors.size() - 1));
+        }
+    }
+    stable_sort(rewards.begin(), rewards.end(),
+                [](pair<double, int> const& lhs, pair<double, int> const& rhs) {
+                    return lhs.first > rhs.first;
+                });
+
+    // The maximal reward that can be achieved in any successor
+    double maxFutureReward = static_cast<double>(state.stepsToGo() - 1) *
+                             SearchEngine::rewardCPF->getMaxVal();
+
+    for (unsigned int i = 0; i < rewards.size(); ++i) {
+        // All remaining actions have a lower immediate reward, so they cannot
+        // be better either
+        if (rewards[i].first + maxFutureReward <= result) {
+            numberOfPrunedActions += rewards.size() - i;
+            break;
+        }
+        double tmp = rewards[i].first;
+        evaluateSuccessor(successors[rewards[i].second], tmp);
+        result = std::max(result, tmp);
     }
 }
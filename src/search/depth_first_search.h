@@ -3,11 +3,32 @@
 
 // Implements a depth first search engine on the determinized task. Is currently
 // only called from within IDS search.
+//
+// If more than one thread is used, the applicable actions of the root state
+// are tasks that are taken by the threads of a thread pool (and by the calling
+// thread) until all have been evaluated. The threads are created once and wait
+// for the next root state in between.
+//
+// If caching is enabled, the value of each expanded state (with its number of
+// remaining steps) is stored in the state value cache, which detects
+// duplicates within an iteration and reuses values in later iterations of IDS.
+// If caching is disabled (e.g., since the RAM limit was reached), a bounded
+// table of the states expanded since the last reset is used instead.
+//
+// In bounded mode, the successors of an expanded state are ordered by
+// immediate reward, and an action is skipped if its immediate reward plus the
+// maximal reward of all remaining steps cannot beat the best action found so
+// far. As this only skips actions that cannot be better than the best one,
+// the computed (and cached) state values are the same as without bounds.
 
 #include "search_engine.h"
 
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <mutex>
 #include <set>
+#include <thread>
 
 class ProstPlanner;
 class UCTSearchEngine;
@@ -15,6 +36,7 @@ class UCTSearchEngine;
 class DepthFirstSearch : public DeterministicSearchEngine {
 public:
     DepthFirstSearch();
+    ~DepthFirstSearch() override;
 
     // Start the search engine to estimate the Q-value of a single action
     void estimateQValue(State const& state, int actionIndex,
@@ -30,6 +52,43 @@ public:
         return false;
     }
 
+    void initStep(State const& /*current*/) override {
+        numberOfDuplicateStates = 0;
+        numberOfPrunedActions = 0;
+    }
+
+    void setNumberOfThreads(int _numberOfThreads) {
+        numberOfThreads = _numberOfThreads;
+    }
+
+    int getNumberOfThreads() const {
+        return numberOfThreads;
+    }
+
+    void setBoundedSearch(bool newValue) {
+        boundedSearch = newValue;
+    }
+
+    bool usesBoundedSearch() const {
+        return boundedSearch;
+    }
+
+    // Forgets the states that have been expanded while caching is disabled
+    // (IDS calls this when it starts with a new root state)
+    void resetExpandedStates();
+
+    // Returns the number of states in the current step whose value was taken
+    // from the table of expanded states
+    long getNumberOfDuplicateStates() const {
+        return numberOfDuplicateStates;
+    }
+
+    // Returns the number of actions in the current step that were skipped
+    // in bounded mode
+    long getNumberOfPrunedActions() const {
+        return numberOfPrunedActions;
+    }
+
     // Print
     void printRoundStatistics(std::string /*indent*/) const override {}
     void printStepStatistics(std::string /*indent*/) const override {}
@@ -40,11 +99,57 @@ private:
     void applyAction(State const& state, int const& actionIndex,
                      double& reward);
 
+    // Adds the reward that can be achieved in State nxt to reward
+    void evaluateSuccessor(State const& nxt, double& reward);
+
     // Expands State state and calculates the reward that can be
     // achieved by applying any action in that state
     void expandState(State const& state, double& res);
 
-    double rewardHelperVar;
+    // Like expandState, but skips actions that cannot be better than the best
+    // action found so far
+    void expandStateWithBounds(State const& state,
+                               std::vector<int> const& actionsToExpand,
+                               double& res);
+
+    // Evaluates the actions of the current root state in parallel
+    void estimateQValuesInParallel(State const& state,
+                                   std::vector<int> const& actionsToExpand,
+                                   std::vector<double>& qValues);
+
+    // Takes actions of the current root state until all have been taken
+    void evaluateRootActions();
+
+    // The main loop of the threads of the thread pool
+    void runThread();
+
+    // The values of states expanded since the last reset if caching is
+    // disabled (at most maxNumberOfExpandedStates)
+    StateValueHashMap expandedStates;
+    std::mutex expandedStatesMutex;
+    static size_t const maxNumberOfExpandedStates = 1 << 18;
+    std::atomic<long> numberOfDuplicateStates;
+
+    bool boundedSearch;
+    std::atomic<long> numberOfPrunedActions;
+
+    int numberOfThreads;
+    std::vector<std::thread> threads;
+
+    // The current root state, its applicable actions and their Q-values. A
+    // thread may only join while the job is open, and the calling thread waits
+    // until all threads that joined are finished.
+    State const* rootState;
+    std::vector<int> rootActionIndices;
+    std::vector<double>* rootQValues;
+    std::atomic<int> nextRootAction;
+    long jobCounter;
+    bool jobIsOpen;
+    int busyThreads;
+    bool terminateThreads;
+    std::mutex jobMutex;
+    std::condition_variable jobStarted;
+    std::condition_variable jobFinished;
 };
 
 #endif
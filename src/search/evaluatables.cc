@@ -9,8 +9,9 @@ using namespace std;
 *****************************************************************/
 
 void Evaluatable::disableCaching() {
-    // We only disable caching if it is done in maps as the
-    // space for vectors is already reserved and thus not growing.
+    // We only disable caching if it is done in maps as the space for
+    // vectors (including lazily filled ones) is already reserved and thus
+    // not growing.
     if (cachingType == MAP) {
         cachingType = DISABLED_MAP;
     }
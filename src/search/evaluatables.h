@@ -3,6 +3,8 @@
 
 #include "logical_expressions.h"
 
+#include "utils/cache_lock.h"
+
 #include <unordered_map>
 
 class Evaluatable {
@@ -11,8 +13,11 @@ public:
         NONE,         // too many variables influence formula
         MAP,          // many variables influence formula
         DISABLED_MAP, // as MAP, but after disableCaching() has been called
-        VECTOR // only few variables influence formula, so we use a vector for
-               // caching
+        VECTOR, // only few variables influence formula, so we use a vector
+                // for caching
+        LAZY_VECTOR // too many variables influence formula to precompute all
+                    // results, but few enough to cache them in a vector that
+                    // is filled on demand
     };
 
     // This function is called for state transitions with KleeneStates. The
@@ -21,6 +26,7 @@ public:
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) {
         assert(res.empty());
+        long stateHashKey = 0;
         switch (kleeneCachingType) {
         case NONE:
             formula->evaluateToKleene(res, current, actions);
@@ -56,6 +62,7 @@ public:
 
             break;
         case VECTOR:
+        case LAZY_VECTOR:
             stateHashKey = current.stateFluentHashKey(hashIndex) +
                            actionHashKeyMap[actions.index];
             assert((current.stateFluentHashKey(hashIndex) >= 0) &&
@@ -76,6 +83,14 @@ public:
     // Properties
     virtual bool isProbabilistic() const = 0;
 
+    // Returns true if the actions with indices actionIndex and
+    // otherActionIndex agree on all action fluents that influence this, i.e.,
+    // if this evaluates to the same result under both actions in every state
+    bool actionsAreEquivalent(int actionIndex, int otherActionIndex) const {
+        return actionHashKeyMap[actionIndex] ==
+               actionHashKeyMap[otherActionIndex];
+    }
+
     // Disable caching
     void disableCaching();
 
@@ -110,10 +125,9 @@ public:
     // state)
     std::vector<long> actionHashKeyMap;
 
-    // This is a temporary variable used in evaluate. It is a member var as
-    // initializing variables in case statements is only possible if additional
-    // parentheses are used
-    long stateHashKey;
+    // Protects the caches of evaluate (but not those of evaluateToKleene) if
+    // several threads search in parallel
+    std::mutex cacheMutex;
 
 protected:
     Evaluatable(std::string _name, int _hashIndex)
@@ -143,6 +157,7 @@ public:
     // Evaluates the formula (deterministically) to a double
     void evaluate(double& res, State const& current,
                   ActionState const& actions) {
+        long stateHashKey = 0;
         switch (cachingType) {
         case NONE:
             formula->evaluate(res, current, actions);
@@ -154,11 +169,9 @@ public:
                    (actionHashKeyMap[actions.index] >= 0) &&
                    (stateHashKey >= 0));
 
-            if (evaluationCacheMap.find(stateHashKey) !=
-                evaluationCacheMap.end()) {
-                res = evaluationCacheMap[stateHashKey];
-            } else {
+            if (!lookUpInCacheMap(stateHashKey, res)) {
                 formula->evaluate(res, current, actions);
+                CacheLock lock(cacheMutex);
                 evaluationCacheMap[stateHashKey] = res;
             }
             break;
@@ -169,10 +182,7 @@ public:
                    (actionHashKeyMap[actions.index] >= 0) &&
                    (stateHashKey >= 0));
 
-            if (evaluationCacheMap.find(stateHashKey) !=
-                evaluationCacheMap.end()) {
-                res = evaluationCacheMap[stateHashKey];
-            } else {
+            if (!lookUpInCacheMap(stateHashKey, res)) {
                 formula->evaluate(res, current, actions);
             }
 
@@ -190,6 +200,25 @@ public:
 
             res = evaluationCacheVector[stateHashKey];
             break;
+        case LAZY_VECTOR:
+            stateHashKey = current.stateFluentHashKey(hashIndex) +
+                           actionHashKeyMap[actions.index];
+
+            assert((current.stateFluentHashKey(hashIndex) >= 0) &&
+                   (actionHashKeyMap[actions.index] >= 0) &&
+                   (stateHashKey >= 0));
+            assert(stateHashKey < evaluationCacheVector.size());
+
+            {
+                CacheLock lock(cacheMutex);
+                res = evaluationCacheVector[stateHashKey];
+            }
+            if (MathUtils::doubleIsMinusInfinity(res)) {
+                formula->evaluate(res, current, actions);
+                CacheLock lock(cacheMutex);
+                evaluationCacheVector[stateHashKey] = res;
+            }
+            break;
         }
     }
 
@@ -199,6 +228,17 @@ public:
 
     std::unordered_map<long, double> evaluationCacheMap;
     std::vector<double> evaluationCacheVector;
+private:
+    // Copies the cached result for key to res if there is one
+    bool lookUpInCacheMap(long const& key, double& res) {
+        CacheLock lock(cacheMutex);
+        auto it = evaluationCacheMap.find(key);
+        if (it == evaluationCacheMap.end()) {
+            return false;
+        }
+        res = it->second;
+        return true;
+    }
 };
 
 class ProbabilisticEvaluatable : public Evaluatable {
@@ -211,6 +251,7 @@ public:
                   ActionState const& actions) {
         assert(res.isUndefined());
 
+        long stateHashKey = 0;
         switch (cachingType) {
         case NONE:
             formula->evaluateToPD(res, current, actions);
@@ -222,11 +263,9 @@ public:
                    (actionHashKeyMap[actions.index] >= 0) &&
                    (stateHashKey >= 0));
 
-            if (evaluationCacheMap.find(stateHashKey) !=
-                evaluationCacheMap.end()) {
-                res = evaluationCacheMap[stateHashKey];
-            } else {
+            if (!lookUpInCacheMap(stateHashKey, res)) {
                 formula->evaluateToPD(res, current, actions);
+                CacheLock lock(cacheMutex);
                 evaluationCacheMap[stateHashKey] = res;
             }
             break;
@@ -237,10 +276,7 @@ public:
                    (actionHashKeyMap[actions.index] >= 0) &&
                    (stateHashKey >= 0));
 
-            if (evaluationCacheMap.find(stateHashKey) !=
-                evaluationCacheMap.end()) {
-                res = evaluationCacheMap[stateHashKey];
-            } else {
+            if (!lookUpInCacheMap(stateHashKey, res)) {
                 formula->evaluateToPD(res, current, actions);
             }
             break;
@@ -256,6 +292,25 @@ public:
 
             res = evaluationCacheVector[stateHashKey];
             break;
+        case LAZY_VECTOR:
+            stateHashKey = current.stateFluentHashKey(hashIndex) +
+                           actionHashKeyMap[actions.index];
+
+            assert((current.stateFluentHashKey(hashIndex) >= 0) &&
+                   (actionHashKeyMap[actions.index] >= 0) &&
+                   (stateHashKey >= 0));
+            assert(stateHashKey < evaluationCacheVector.size());
+
+            {
+                CacheLock lock(cacheMutex);
+                res = evaluationCacheVector[stateHashKey];
+            }
+            if (res.isUndefined()) {
+                formula->evaluateToPD(res, current, actions);
+                CacheLock lock(cacheMutex);
+                evaluationCacheVector[stateHashKey] = res;
+            }
+            break;
         }
     }
 
@@ -265,6 +320,17 @@ public:
 
     std::unordered_map<long, DiscretePD> evaluationCacheMap;
     std::vector<DiscretePD> evaluationCacheVector;
+private:
+    // Copies the cached result for key to res if there is one
+    bool lookUpInCacheMap(long const& key, DiscretePD& res) {
+        CacheLock lock(cacheMutex);
+        auto it = evaluationCacheMap.find(key);
+        if (it == evaluationCacheMap.end()) {
+            return false;
+        }
+        res = it->second;
+        return true;
+    }
 };
 
 class RewardFunction : public DeterministicEvaluatable {
@@ -88,13 +88,23 @@ void ExhaustiveMDPGenerator::expandState(State const& state) {
     assert(states.count(state));
     int stateID = states[state];
     vector<int> actionsToExpand = getApplicableActions(state);
+    // Successors are computed incrementally from the successor under the first
+    // applicable action
+    PDState base(SearchEngine::horizon);
+    int baseActionID = -1;
     for (int actionID = 0; actionID < actionsToExpand.size(); ++actionID) {
         if (actionsToExpand[actionID] == actionID) {
             ++applicableActionCounter[actionID];
             // cout << "action " << actionStates[actionID].toCompactString() << " (" << actionID << ")" << endl;
             PDState next(SearchEngine::horizon);
             // cout << state.hashKey << endl;
-            calcSuccessorState(state, actionID, next);
+            if (baseActionID < 0) {
+                calcSuccessorState(state, actionID, next);
+                base.setTo(next);
+                baseActionID = actionID;
+            } else {
+                calcSuccessorState(state, actionID, base, baseActionID, next);
+            }
             // cout << "successor computed!" << endl;
             double reward = 0.0;
             calcReward(state, actionID, reward);
@@ -110,7 +120,13 @@ void ExhaustiveMDPGenerator::expandState(State const& state) {
             // TODO: Just copy this transition!
             PDState next(SearchEngine::horizon);
             // cout << state.hashKey << endl;
-            calcSuccessorState(state, actionID, next);
+            if (baseActionID < 0) {
+                calcSuccessorState(state, actionID, next);
+                base.setTo(next);
+                baseActionID = actionID;
+            } else {
+                calcSuccessorState(state, actionID, base, baseActionID, next);
+            }
             // cout << "successor computed!" << endl;
             double reward = 0.0;
             calcReward(state, actionID, reward);
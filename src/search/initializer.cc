@@ -78,6 +78,11 @@ void Initializer::initSession() {
     heuristic->initSession();
 }
 
+void Initializer::adoptLearnedParameters(Initializer const* other) {
+    assert(heuristic && other->heuristic);
+    heuristic->adoptLearnedParameters(other->heuristic);
+}
+
 void Initializer::initRound() {
     assert(heuristic);
     heuristic->initRound();
@@ -159,15 +164,15 @@ void ExpandNodeInitializer::initialize(SearchNode* node, State const& current) {
 
     for (unsigned int index = 0; index < node->children.size(); ++index) {
         if (actionsToExpand[index] == index) {
+            double initialValue = heuristicWeight * initialQValues[index];
             node->children[index] = thts->createChanceNode(1.0);
-            node->children[index]->futureReward =
-                heuristicWeight * initialQValues[index];
+            node->children[index]->futureReward = initialValue;
             node->children[index]->numberOfVisits = numberOfInitialVisits;
             node->children[index]->initialized = true;
 
             node->numberOfVisits += numberOfInitialVisits;
-            node->futureReward = std::max(node->futureReward,
-                                          node->children[index]->futureReward);
+            node->futureReward = std::max<double>(node->futureReward,
+                                                  initialValue);
 
             // Logger::logLine("Initialized child " +
             //                 SearchEngine::actionStates[index].toCompactString(),
@@ -217,12 +222,12 @@ void SingleChildInitializer::initialize(SearchNode* node,
     double initialQValue = 0.0;
     heuristic->estimateQValue(current, actionIndex, initialQValue);
 
-    node->children[actionIndex]->futureReward = heuristicWeight * initialQValue;
+    double initialValue = heuristicWeight * initialQValue;
+    node->children[actionIndex]->futureReward = initialValue;
     node->children[actionIndex]->numberOfVisits = numberOfInitialVisits;
     node->children[actionIndex]->initialized = true;
     node->numberOfVisits += numberOfInitialVisits;
-    node->futureReward =
-        std::max(node->futureReward, node->children[actionIndex]->futureReward);
+    node->futureReward = std::max<double>(node->futureReward, initialValue);
 
     node->initialized = (candidates.size() == 1);
 
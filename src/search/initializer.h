@@ -23,6 +23,9 @@ public:
     virtual void disableCaching();
 
     virtual void initSession();
+    // Takes over what the heuristic of other (an initializer with the same
+    // configuration) has learned in its initSession
+    virtual void adoptLearnedParameters(Initializer const* other);
     virtual void initRound();
     virtual void finishRound();
     virtual void initStep(State const& current);
@@ -11,10 +11,12 @@
 #include <algorithm>
 #include <iostream>
 #include <numeric>
+#include <thread>
 
 using namespace std;
 
 IDS::HashMap IDS::rewardCache;
+std::mutex IDS::rewardCacheMutex;
 
 IDS::IDS()
     : DeterministicSearchEngine("IDS"),
@@ -25,6 +27,7 @@ IDS::IDS()
       ramLimitReached(false),
       strictTerminationTimeout(0.1),
       terminateWithReasonableAction(true),
+      numberOfLearningThreads(1),
       accumulatedSearchDepthInCurrentStep(0),
       numberOfRunsInCurrentStep(0),
       cacheHitsInCurrentStep(0),
@@ -53,6 +56,16 @@ bool IDS::setValueFromString(string& param, string& value) {
     } else if (param == "-lrn") {
         setIsLearning(atoi(value.c_str()));
         return true;
+    } else if (param == "-lthreads") {
+        setNumberOfLearningThreads(atoi(value.c_str()));
+        return numberOfLearningThreads > 0;
+    } else if (param == "-dfs-threads") {
+        int numberOfDFSThreads = atoi(value.c_str());
+        setNumberOfDFSThreads(numberOfDFSThreads);
+        return numberOfDFSThreads > 0;
+    } else if (param == "-bb") {
+        setBoundedDFS(atoi(value.c_str()));
+        return true;
     }
 
     return SearchEngine::setValueFromString(param, value);
@@ -64,6 +77,14 @@ void IDS::setMaxSearchDepth(int newValue) {
     elapsedTime.resize(newValue + 1);
 }
 
+void IDS::setNumberOfDFSThreads(int newValue) {
+    dfs->setNumberOfThreads(newValue);
+}
+
+void IDS::setBoundedDFS(bool newValue) {
+    dfs->setBoundedSearch(newValue);
+}
+
 void IDS::setCachingEnabled(bool newValue) {
     SearchEngine::setCachingEnabled(newValue);
     dfs->setCachingEnabled(newValue);
@@ -91,10 +112,12 @@ void IDS::initSession() {
 
         // Perform IDS for all states in trainingSet and record the time it
         // takes
-        for (State const& state : trainingSet) {
-            vector<double> res(numberOfActions);
-            vector<int> actionsToExpand = getApplicableActions(state);
-            estimateQValues(state, actionsToExpand, res);
+        if ((numberOfLearningThreads > 1) && (trainingSet.size() > 1)) {
+            learnInParallel();
+        } else {
+            vector<size_t> trainingStateIndices(trainingSet.size());
+            iota(trainingStateIndices.begin(), trainingStateIndices.end(), 0);
+            learn(trainingStateIndices);
         }
         isLearning = false;
         cachingEnabled = cachingEnabledBeforeLearning;
@@ -143,6 +166,79 @@ void IDS::initSession() {
     Logger::logLine(name + ": ...finished", Verbosity::VERBOSE);
 }
 
+void IDS::adoptLearnedParameters(SearchEngine const* other) {
+    assert(dynamic_cast<IDS const*>(other));
+    setIsLearning(false);
+    setMaxSearchDepth(other->getMaxSearchDepth());
+}
+
+void IDS::learn(vector<size_t> const& trainingStateIndices) {
+    for (size_t index : trainingStateIndices) {
+        State const& state = trainingSet[index];
+        vector<double> res(numberOfActions);
+        vector<int> actionsToExpand = getApplicableActions(state);
+        estimateQValues(state, actionsToExpand, res);
+    }
+}
+
+void IDS::learnInParallel() {
+    // Each thread learns with a separate IDS search engine (and a separate DFS
+    // search engine) on every numberOfThreads-th training state
+    int numberOfThreads =
+        min(numberOfLearningThreads, static_cast<int>(trainingSet.size()));
+    vector<vector<size_t>> trainingStateIndices(numberOfThreads);
+    for (size_t index = 0; index < trainingSet.size(); ++index) {
+        trainingStateIndices[index % numberOfThreads].push_back(index);
+    }
+
+    vector<IDS*> learners(1, this);
+    for (int i = 1; i < numberOfThreads; ++i) {
+        IDS* learner = new IDS();
+        learner->setMaxSearchDepth(maxSearchDepth);
+        learner->setStrictTerminationTimeout(strictTerminationTimeout);
+        learner->cachingEnabled = false;
+        learner->dfs->setCachingEnabled(dfs->cachingIsEnabled());
+        learner->dfs->setBoundedSearch(dfs->usesBoundedSearch());
+        learner->dfs->initSession();
+        learners.push_back(learner);
+    }
+
+    // The caches that are shared among all search engines must be locked
+    // while more than one thread is running
+    CacheLock::parallelSearch = true;
+    vector<thread> threads;
+    for (int i = 1; i < numberOfThreads; ++i) {
+        IDS* learner = learners[i];
+        vector<size_t> const& indices = trainingStateIndices[i];
+        threads.emplace_back([learner, &indices]() { learner->learn(indices); });
+    }
+    learn(trainingStateIndices[0]);
+    for (thread& t : threads) {
+        t.join();
+    }
+    CacheLock::parallelSearch = false;
+
+    // Merge the recorded times as if all training states had been learned in
+    // this search engine: if the strict timeout was violated in any thread,
+    // the maximal search depth and the recorded depths are reduced
+    size_t numberOfDepths = elapsedTime.size();
+    for (IDS const* learner : learners) {
+        maxSearchDepth = min(maxSearchDepth, learner->maxSearchDepth);
+        numberOfDepths = min(numberOfDepths, learner->elapsedTime.size());
+    }
+    elapsedTime.resize(numberOfDepths);
+    for (int i = 1; i < numberOfThreads; ++i) {
+        IDS* learner = learners[i];
+        for (size_t depth = 0; depth < numberOfDepths; ++depth) {
+            vector<double> const& times = learner->elapsedTime[depth];
+            elapsedTime[depth].insert(elapsedTime[depth].end(), times.begin(),
+                                      times.end());
+        }
+        delete learner->dfs;
+        delete learner;
+    }
+}
+
 void IDS::initRound() {
     // Reset per round statistics
     avgSearchDepthInFirstRelevantState = -1.0;
@@ -209,17 +305,29 @@ void IDS::estimateQValue(State const& state, int actionIndex, double& qValue) {
         return mlh->estimateQValue(state, actionIndex, qValue);
     }
 
-    HashMap::iterator it = rewardCache.find(state);
-    if (it != rewardCache.end() &&
-        !MathUtils::doubleIsMinusInfinity(it->second[actionIndex])) {
+    bool isCached = false;
+    {
+        CacheLock lock(rewardCacheMutex);
+        HashMap::const_iterator it = rewardCache.find(state);
+        if (it != rewardCache.end() &&
+            !MathUtils::doubleIsMinusInfinity(it->second[actionIndex])) {
+            qValue = it->second[actionIndex] *
+                     static_cast<double>(state.stepsToGo());
+            isCached = true;
+        }
+    }
+
+    if (isCached) {
         ++cacheHitsInCurrentStep;
-        qValue =
-            it->second[actionIndex] * static_cast<double>(state.stepsToGo());
     } else {
         stopwatch.reset();
 
         maxSearchDepthForThisStep = std::min(maxSearchDepth, state.stepsToGo());
 
+        // The table of expanded states is reset for each new root state and
+        // then reused in all iterations of deepening search from that state
+        dfs->resetExpandedStates();
+
         State currentState(state);
         currentState.stepsToGo() = 1;
         do {
@@ -233,12 +341,13 @@ void IDS::estimateQValue(State const& state, int actionIndex, double& qValue) {
         //  the result was achieved with a reasonable action, with a timeout or
         //  on a state with sufficient depth
         if (cachingEnabled) {
-            if (it == rewardCache.end()) {
-                rewardCache[currentState] =
-                    vector<double>(SearchEngine::numberOfActions,
-                                   -std::numeric_limits<double>::max());
+            CacheLock lock(rewardCacheMutex);
+            vector<double>& cachedQValues = rewardCache[currentState];
+            if (cachedQValues.empty()) {
+                cachedQValues.assign(SearchEngine::numberOfActions,
+                                     -std::numeric_limits<double>::max());
             }
-            rewardCache[currentState][actionIndex] = qValue;
+            cachedQValues[actionIndex] = qValue;
         }
         qValue *= static_cast<double>(state.stepsToGo());
 
@@ -258,23 +367,36 @@ void IDS::estimateQValues(State const& state,
         return mlh->estimateQValues(state, actionsToExpand, qValues);
     }
 
-    HashMap::iterator it = rewardCache.find(state);
-    if (it != rewardCache.end()) {
-        ++cacheHitsInCurrentStep;
-        assert(qValues.size() == it->second.size());
-        for (size_t index = 0; index < qValues.size(); ++index) {
-            if (actionsToExpand[index] == index) {
-                qValues[index] =
-                    it->second[index] * static_cast<double>(state.stepsToGo());
-            } else {
-                qValues[index] = -std::numeric_limits<double>::max();
+    bool isCached = false;
+    {
+        CacheLock lock(rewardCacheMutex);
+        HashMap::const_iterator it = rewardCache.find(state);
+        if (it != rewardCache.end()) {
+            assert(qValues.size() == it->second.size());
+            for (size_t index = 0; index < qValues.size(); ++index) {
+                if (actionsToExpand[index] == index) {
+                    qValues[index] = it->second[index] *
+                                     static_cast<double>(state.stepsToGo());
+                } else {
+                    qValues[index] = -std::numeric_limits<double>::max();
+                }
             }
+            isCached = true;
         }
+    }
+
+    if (isCached) {
+        ++cacheHitsInCurrentStep;
     } else {
         stopwatch.reset();
+        learningStopwatch.reset();
 
         maxSearchDepthForThisStep = std::min(maxSearchDepth, state.stepsToGo());
 
+        // The table of expanded states is reset for each new root state and
+        // then reused in all iterations of deepening search from that state
+        dfs->resetExpandedStates();
+
         State currentState(state);
         currentState.stepsToGo() = 1;
         do {
@@ -289,11 +411,13 @@ void IDS::estimateQValues(State const& state,
         //  the result was achieved with a reasonable action, with a timeout or
         //  on a state with sufficient depth
         if (cachingEnabled) {
-            rewardCache[currentState] = qValues;
+            CacheLock lock(rewardCacheMutex);
+            vector<double>& cachedQValues = rewardCache[currentState];
+            cachedQValues = qValues;
             for (size_t index = 0; index < qValues.size(); ++index) {
                 if (actionsToExpand[index] == index) {
                     qValues[index] *= multiplier;
-                    rewardCache[currentState][index] /=
+                    cachedQValues[index] /=
                         static_cast<double>(currentState.stepsToGo());
                 }
             }
@@ -345,6 +469,7 @@ bool IDS::moreIterations(int const& stepsToGo,
 
     // 0. If we are learning, we apply different termination criteria
     if (isLearning) {
+        time = learningStopwatch();
         assert(elapsedTime.size() > stepsToGo);
         elapsedTime[stepsToGo].push_back(time);
 
@@ -407,6 +532,19 @@ void IDS::printConfig(std::string indent) const {
         Verbosity::VERBOSE);
     Logger::logLine(indent + "Timeout: " + to_string(timeout),
                     Verbosity::VERBOSE);
+    Logger::logLine(indent + "Learning threads: " +
+                        to_string(numberOfLearningThreads),
+                    Verbosity::VERBOSE);
+    Logger::logLine(
+        indent + "DFS threads: " + to_string(dfs->getNumberOfThreads()),
+        Verbosity::VERBOSE);
+    if (dfs->usesBoundedSearch()) {
+        Logger::logLine(indent + "Branch and bound in DFS: enabled",
+                        Verbosity::VERBOSE);
+    } else {
+        Logger::logLine(indent + "Branch and bound in DFS: disabled",
+                        Verbosity::VERBOSE);
+    }
     if (terminateWithReasonableAction) {
         Logger::logLine(indent + "Terminate with reasonable action: enabled",
                         Verbosity::VERBOSE);
@@ -429,6 +567,16 @@ void IDS::printStepStatistics(std::string indent) const {
         Verbosity::NORMAL);
     Logger::logLine(indent + "Cache hits: " + to_string(cacheHitsInCurrentStep),
                     Verbosity::VERBOSE);
+    if (!cachingEnabled) {
+        Logger::logLine(indent + "Duplicate states detected by DFS: " +
+                            to_string(dfs->getNumberOfDuplicateStates()),
+                        Verbosity::VERBOSE);
+    }
+    if (dfs->usesBoundedSearch()) {
+        Logger::logLine(indent + "Actions pruned by DFS: " +
+                            to_string(dfs->getNumberOfPrunedActions()),
+                        Verbosity::VERBOSE);
+    }
 
     if (numberOfRunsInCurrentStep > 0) {
         double avg = static_cast<double>(accumulatedSearchDepthInCurrentStep) /
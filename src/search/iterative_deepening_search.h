@@ -28,6 +28,9 @@ public:
     // Notify the search engine that the session starts
     void initSession() override;
 
+    // Takes over the search depth that other has learned
+    void adoptLearnedParameters(SearchEngine const* other) override;
+
     // Notify the search engine that a new round starts or ends
     void initRound() override;
     void finishRound() override;
@@ -62,6 +65,14 @@ public:
         isLearning = newValue;
     }
 
+    void setNumberOfLearningThreads(int newValue) {
+        numberOfLearningThreads = newValue;
+    }
+
+    void setNumberOfDFSThreads(int newValue);
+
+    void setBoundedDFS(bool newValue);
+
     bool usesBDDs() const override {
         return false;
     }
@@ -76,6 +87,7 @@ public:
                                        State::HashWithoutRemSteps,
                                        State::EqualWithoutRemSteps>;
     static HashMap rewardCache;
+    static std::mutex rewardCacheMutex;
 
 protected:
     // Decides whether more iterations are possible and reasonable
@@ -84,6 +96,14 @@ protected:
                         std::vector<double>& qValues);
     inline bool moreIterations(int const& stepsToGo);
 
+    // Performs IDS for the training states with the given indices and records
+    // the time it takes
+    void learn(std::vector<size_t> const& trainingStateIndices);
+
+    // Distributes the training set among numberOfLearningThreads IDS search
+    // engines that learn simultaneously, and merges the recorded times
+    void learnInParallel();
+
     void createMinimalLookaheadSearch();
 
     void printRewardCacheUsage(
@@ -96,9 +116,12 @@ protected:
     // is faster and better informed, so this one is used
     MinimalLookaheadSearch* mlh;
 
-    // Learning related variables
+    // Learning related variables (the recorded times are measured in CPU time
+    // of the learning thread, such that they are independent of the number of
+    // threads that learn simultaneously)
     bool isLearning;
     std::vector<std::vector<double>> elapsedTime;
+    ThreadStopwatch learningStopwatch;
 
     // Stopwatch used to make sure that computation doesn't take too much time
     Stopwatch stopwatch;
@@ -112,6 +135,7 @@ protected:
     // Parameter
     double strictTerminationTimeout;
     bool terminateWithReasonableAction;
+    int numberOfLearningThreads;
 
     // Per step statistics
     int accumulatedSearchDepthInCurrentStep;
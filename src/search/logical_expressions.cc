@@ -5,13 +5,65 @@
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
 
+#include <deque>
 #include <iostream>
+#include <unordered_map>
 
 using namespace std;
 
+namespace {
+// Maps the description of each non-atomic expression that was created by
+// createFromString to the created expression
+unordered_map<string, LogicalExpression*> createdExpressions;
+int numberOfSharedSubformulas = 0;
+
+// The memoization tables are indexed by the memoIndex of a shared subformula.
+// An entry is valid if its stamp equals the current memoStamp.
+thread_local long lastMemoStamp = 0;
+thread_local vector<long> valueStamps;
+thread_local vector<double> memoizedValues;
+thread_local vector<long> pdStamps;
+thread_local vector<DiscretePD> memoizedPDs;
+thread_local vector<long> truthProbStamps;
+thread_local vector<double> memoizedTruthProbs;
+} // namespace
+
+thread_local long LogicalExpression::memoStamp = 0;
+
 LogicalExpression* LogicalExpression::createFromString(string& desc) {
     StringUtils::trim(desc);
 
+    // Atomic expressions are not shared via createdExpressions: fluents are
+    // unique anyway, and constants are cheaper to evaluate than to memoize
+    if (StringUtils::startsWith(desc, "$")) {
+        return createExpression(desc);
+    }
+
+    // All other expressions are created only once for each description, so
+    // the formulas of all evaluatables form a DAG with shared subformulas
+    auto it = createdExpressions.find(desc);
+    if (it != createdExpressions.end()) {
+        LogicalExpression* expr = it->second;
+        if (expr->memoIndex < 0) {
+            expr->memoIndex = numberOfSharedSubformulas;
+            ++numberOfSharedSubformulas;
+        }
+        return expr;
+    }
+
+    string key = desc;
+    LogicalExpression* expr = createExpression(desc);
+    createdExpressions[key] = expr;
+    return expr;
+}
+
+void LogicalExpression::resetSharedSubformulas() {
+    createdExpressions.clear();
+    numberOfSharedSubformulas = 0;
+}
+
+LogicalExpression* LogicalExpression::createExpression(string& desc) {
+
     if (StringUtils::startsWith(desc, "$s(")) {
         desc = desc.substr(3, desc.length() - 4);
         int index = atoi(desc.c_str());
@@ -153,6 +205,60 @@ LogicalExpressionPair LogicalExpression::splitExpressionPair(string& desc) {
     return make_pair(first, second);
 }
 
+/*****************************************************************
+                 Memoization of shared subformulas
+*****************************************************************/
+
+void LogicalExpression::startMemoization() {
+    assert(memoStamp == 0);
+    if (valueStamps.size() < numberOfSharedSubformulas) {
+        valueStamps.resize(numberOfSharedSubformulas, 0);
+        memoizedValues.resize(numberOfSharedSubformulas);
+        pdStamps.resize(numberOfSharedSubformulas, 0);
+        memoizedPDs.resize(numberOfSharedSubformulas);
+        truthProbStamps.resize(numberOfSharedSubformulas, 0);
+        memoizedTruthProbs.resize(numberOfSharedSubformulas);
+    }
+    ++lastMemoStamp;
+    memoStamp = lastMemoStamp;
+}
+
+void LogicalExpression::stopMemoization() {
+    memoStamp = 0;
+}
+
+void LogicalExpression::evaluateMemoized(double& res, State const& current,
+                                         ActionState const& actions) const {
+    assert(memoIndex < valueStamps.size());
+    if (valueStamps[memoIndex] != memoStamp) {
+        doEvaluate(memoizedValues[memoIndex], current, actions);
+        valueStamps[memoIndex] = memoStamp;
+    }
+    res = memoizedValues[memoIndex];
+}
+
+void LogicalExpression::evaluateToPDMemoized(DiscretePD& res,
+                                             State const& current,
+                                             ActionState const& actions) const {
+    assert(memoIndex < pdStamps.size());
+    if (pdStamps[memoIndex] != memoStamp) {
+        doEvaluateToPD(memoizedPDs[memoIndex], current, actions);
+        pdStamps[memoIndex] = memoStamp;
+    }
+    res = memoizedPDs[memoIndex];
+}
+
+void LogicalExpression::evaluateToTruthProbabilityMemoized(
+    double& res, State const& current, ActionState const& actions) const {
+    assert(memoIndex < truthProbStamps.size());
+    if (truthProbStamps[memoIndex] != memoStamp) {
+        doEvaluateToTruthProbability(memoizedTruthProbs[memoIndex], current,
+                                     actions);
+        truthProbStamps[memoIndex] = memoStamp;
+    }
+    res = memoizedTruthProbs[memoIndex];
+}
+
 #include "logical_expressions_includes/evaluate.cc"
 #include "logical_expressions_includes/evaluate_to_kleene.cc"
 #include "logical_expressions_includes/evaluate_to_pd.cc"
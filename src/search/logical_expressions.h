@@ -18,17 +18,82 @@ public:
     static std::vector<LogicalExpression*> createExpressions(std::string& desc);
     static LogicalExpressionPair splitExpressionPair(std::string& desc);
 
+    // Removes all expressions created by createFromString from the table that
+    // is used to share identical subformulas
+    static void resetSharedSubformulas();
+
+    // The results of subformulas that occur in several formulas are memoized
+    // between a call to startMemoization and the next call to stopMemoization.
+    // All formulas that are evaluated in between must hence be evaluated in
+    // the same state and under the same action. Memoization is per thread.
+    static void startMemoization();
+    static void stopMemoization();
+
     virtual ~LogicalExpression() {}
 
-    virtual void evaluate(double& res, State const& current,
-                          ActionState const& actions) const;
-    virtual void evaluateToPD(DiscretePD& res, State const& current,
-                              ActionState const& actions) const;
+    void evaluate(double& res, State const& current,
+                  ActionState const& actions) const {
+        if ((memoIndex < 0) || (memoStamp == 0)) {
+            doEvaluate(res, current, actions);
+        } else {
+            evaluateMemoized(res, current, actions);
+        }
+    }
+
+    void evaluateToPD(DiscretePD& res, State const& current,
+                      ActionState const& actions) const {
+        if ((memoIndex < 0) || (memoStamp == 0)) {
+            doEvaluateToPD(res, current, actions);
+        } else {
+            evaluateToPDMemoized(res, current, actions);
+        }
+    }
+
+    // Computes the probability that this evaluates to a value other than 0.
+    // This is equivalent to evaluateToPD followed by truthProbability(), but
+    // it is overwritten to avoid building distributions where possible.
+    void evaluateToTruthProbability(double& res, State const& current,
+                                    ActionState const& actions) const {
+        if ((memoIndex < 0) || (memoStamp == 0)) {
+            doEvaluateToTruthProbability(res, current, actions);
+        } else {
+            evaluateToTruthProbabilityMemoized(res, current, actions);
+        }
+    }
+
     virtual void evaluateToKleene(std::set<double>& res,
                                   KleeneState const& current,
                                   ActionState const& actions) const;
 
     virtual void print(std::ostream& out) const = 0;
+
+protected:
+    LogicalExpression() : memoIndex(-1) {}
+
+    virtual void doEvaluate(double& res, State const& current,
+                            ActionState const& actions) const;
+    virtual void doEvaluateToPD(DiscretePD& res, State const& current,
+                                ActionState const& actions) const;
+    virtual void doEvaluateToTruthProbability(double& res,
+                                              State const& current,
+                                              ActionState const& actions) const;
+
+private:
+    static LogicalExpression* createExpression(std::string& desc);
+
+    void evaluateMemoized(double& res, State const& current,
+                          ActionState const& actions) const;
+    void evaluateToPDMemoized(DiscretePD& res, State const& current,
+                              ActionState const& actions) const;
+    void evaluateToTruthProbabilityMemoized(double& res, State const& current,
+                                            ActionState const& actions) const;
+
+    // Each subformula that is shared by several formulas has a unique index
+    // into the memoization tables (and -1 otherwise)
+    int memoIndex;
+
+    // Identifies the current call of startMemoization (0 if not memoizing)
+    static thread_local long memoStamp;
 };
 
 /*****************************************************************
@@ -54,10 +119,13 @@ public:
                              std::vector<std::string> _values)
         : StateFluent(_index, _name, _values) {}
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
+    void doEvaluateToTruthProbability(
+        double& res, State const& current,
+        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 };
@@ -68,10 +136,13 @@ public:
                              std::vector<std::string> _values)
         : StateFluent(_index, _name, _values) {}
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
+    void doEvaluateToTruthProbability(
+        double& res, State const& current,
+        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 };
@@ -87,10 +158,13 @@ public:
     bool isFDR;
     std::vector<std::string> values;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
+    void doEvaluateToTruthProbability(
+        double& res, State const& current,
+        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -103,10 +177,13 @@ public:
 
     double value;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
+    void doEvaluateToTruthProbability(
+        double& res, State const& current,
+        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -123,10 +200,13 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
+    void doEvaluateToTruthProbability(
+        double& res, State const& current,
+        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -139,10 +219,13 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
+    void doEvaluateToTruthProbability(
+        double& res, State const& current,
+        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -155,10 +238,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -172,10 +255,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -188,10 +271,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -205,10 +288,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -222,10 +305,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -238,10 +321,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -254,10 +337,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -270,10 +353,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -286,10 +369,10 @@ public:
 
     std::vector<LogicalExpression*> exprs;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -306,10 +389,13 @@ public:
 
     LogicalExpression* expr;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
+    void doEvaluateToTruthProbability(
+        double& res, State const& current,
+        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -322,10 +408,10 @@ public:
 
     LogicalExpression* expr;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -342,10 +428,13 @@ public:
 
     LogicalExpression* expr;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
+    void doEvaluateToTruthProbability(
+        double& res, State const& current,
+        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -361,10 +450,10 @@ public:
     std::vector<LogicalExpression*> values;
     std::vector<LogicalExpression*> probabilities;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -384,10 +473,10 @@ public:
     std::vector<LogicalExpression*> conditions;
     std::vector<LogicalExpression*> effects;
 
-    void evaluate(double& res, State const& current,
-                  ActionState const& actions) const override;
-    void evaluateToPD(DiscretePD& res, State const& current,
-                      ActionState const& actions) const override;
+    void doEvaluate(double& res, State const& current,
+                    ActionState const& actions) const override;
+    void doEvaluateToPD(DiscretePD& res, State const& current,
+                        ActionState const& actions) const override;
     void evaluateToKleene(std::set<double>& res, KleeneState const& current,
                           ActionState const& actions) const override;
 
@@ -1,5 +1,5 @@
-void LogicalExpression::evaluate(double& /*res*/, State const& /*current*/,
-                                 ActionState const& /*actions*/) const {
+void LogicalExpression::doEvaluate(double& /*res*/, State const& /*current*/,
+                                   ActionState const& /*actions*/) const {
     assert(false);
 }
 
@@ -7,23 +7,23 @@ void LogicalExpression::evaluate(double& /*res*/, State const& /*current*/,
                            Atomics
 *****************************************************************/
 
-void DeterministicStateFluent::evaluate(double& res, State const& current,
-                                        ActionState const& /*actions*/) const {
+void DeterministicStateFluent::doEvaluate(
+    double& res, State const& current, ActionState const& /*actions*/) const {
     res = current.deterministicStateFluent(index);
 }
 
-void ProbabilisticStateFluent::evaluate(double& res, State const& current,
-                                        ActionState const& /*actions*/) const {
+void ProbabilisticStateFluent::doEvaluate(
+    double& res, State const& current, ActionState const& /*actions*/) const {
     res = current.probabilisticStateFluent(index);
 }
 
-void ActionFluent::evaluate(double& res, State const& /*current*/,
-                            ActionState const& actions) const {
+void ActionFluent::doEvaluate(double& res, State const& /*current*/,
+                              ActionState const& actions) const {
     res = actions[index];
 }
 
-void NumericConstant::evaluate(double& res, State const& /*current*/,
-                               ActionState const& /*actions*/) const {
+void NumericConstant::doEvaluate(double& res, State const& /*current*/,
+                                 ActionState const& /*actions*/) const {
     res = value;
 }
 
@@ -31,8 +31,8 @@ void NumericConstant::evaluate(double& res, State const& /*current*/,
                            Connectives
 *****************************************************************/
 
-void Conjunction::evaluate(double& res, State const& current,
-                           ActionState const& actions) const {
+void Conjunction::doEvaluate(double& res, State const& current,
+                             ActionState const& actions) const {
     for (unsigned int i = 0; i < exprs.size(); ++i) {
         exprs[i]->evaluate(res, current, actions);
 
@@ -45,8 +45,8 @@ void Conjunction::evaluate(double& res, State const& current,
     res = 1.0; // The empty conjunction is true
 }
 
-void Disjunction::evaluate(double& res, State const& current,
-                           ActionState const& actions) const {
+void Disjunction::doEvaluate(double& res, State const& current,
+                             ActionState const& actions) const {
     for (unsigned int i = 0; i < exprs.size(); ++i) {
         exprs[i]->evaluate(res, current, actions);
 
@@ -59,8 +59,8 @@ void Disjunction::evaluate(double& res, State const& current,
     res = 0.0; // The empty disjunction is false
 }
 
-void EqualsExpression::evaluate(double& res, State const& current,
-                                ActionState const& actions) const {
+void EqualsExpression::doEvaluate(double& res, State const& current,
+                                  ActionState const& actions) const {
     assert(exprs.size() == 2);
 
     double lhs = 0.0;
@@ -72,8 +72,8 @@ void EqualsExpression::evaluate(double& res, State const& current,
     res = MathUtils::doubleIsEqual(lhs, rhs);
 }
 
-void GreaterExpression::evaluate(double& res, State const& current,
-                                 ActionState const& actions) const {
+void GreaterExpression::doEvaluate(double& res, State const& current,
+                                   ActionState const& actions) const {
     assert(exprs.size() == 2);
 
     double lhs = 0.0;
@@ -85,8 +85,8 @@ void GreaterExpression::evaluate(double& res, State const& current,
     res = MathUtils::doubleIsGreater(lhs, rhs);
 }
 
-void LowerExpression::evaluate(double& res, State const& current,
-                               ActionState const& actions) const {
+void LowerExpression::doEvaluate(double& res, State const& current,
+                                 ActionState const& actions) const {
     assert(exprs.size() == 2);
 
     double lhs = 0.0;
@@ -98,8 +98,8 @@ void LowerExpression::evaluate(double& res, State const& current,
     res = MathUtils::doubleIsSmaller(lhs, rhs);
 }
 
-void GreaterEqualsExpression::evaluate(double& res, State const& current,
-                                       ActionState const& actions) const {
+void GreaterEqualsExpression::doEvaluate(double& res, State const& current,
+                                         ActionState const& actions) const {
     assert(exprs.size() == 2);
 
     double lhs = 0.0;
@@ -111,8 +111,8 @@ void GreaterEqualsExpression::evaluate(double& res, State const& current,
     res = MathUtils::doubleIsGreaterOrEqual(lhs, rhs);
 }
 
-void LowerEqualsExpression::evaluate(double& res, State const& current,
-                                     ActionState const& actions) const {
+void LowerEqualsExpression::doEvaluate(double& res, State const& current,
+                                       ActionState const& actions) const {
     assert(exprs.size() == 2);
 
     double lhs = 0.0;
@@ -124,8 +124,8 @@ void LowerEqualsExpression::evaluate(double& res, State const& current,
     res = MathUtils::doubleIsSmallerOrEqual(lhs, rhs);
 }
 
-void Addition::evaluate(double& res, State const& current,
-                        ActionState const& actions) const {
+void Addition::doEvaluate(double& res, State const& current,
+                          ActionState const& actions) const {
     res = 0.0;
     for (unsigned int i = 0; i < exprs.size(); ++i) {
         double exprRes = 0.0;
@@ -134,8 +134,8 @@ void Addition::evaluate(double& res, State const& current,
     }
 }
 
-void Subtraction::evaluate(double& res, State const& current,
-                           ActionState const& actions) const {
+void Subtraction::doEvaluate(double& res, State const& current,
+                             ActionState const& actions) const {
     exprs[0]->evaluate(res, current, actions);
 
     for (unsigned int i = 1; i < exprs.size(); ++i) {
@@ -145,8 +145,8 @@ void Subtraction::evaluate(double& res, State const& current,
     }
 }
 
-void Multiplication::evaluate(double& res, State const& current,
-                              ActionState const& actions) const {
+void Multiplication::doEvaluate(double& res, State const& current,
+                                ActionState const& actions) const {
     res = 1.0;
     for (unsigned int i = 0; i < exprs.size(); ++i) {
         double exprRes = 0.0;
@@ -159,8 +159,8 @@ void Multiplication::evaluate(double& res, State const& current,
     }
 }
 
-void Division::evaluate(double& res, State const& current,
-                        ActionState const& actions) const {
+void Division::doEvaluate(double& res, State const& current,
+                          ActionState const& actions) const {
     exprs[0]->evaluate(res, current, actions);
 
     for (unsigned int i = 1; i < exprs.size(); ++i) {
@@ -179,15 +179,15 @@ void Division::evaluate(double& res, State const& current,
                           Unaries
 *****************************************************************/
 
-void Negation::evaluate(double& res, State const& current,
-                        ActionState const& actions) const {
+void Negation::doEvaluate(double& res, State const& current,
+                          ActionState const& actions) const {
     expr->evaluate(res, current, actions);
 
     res = MathUtils::doubleIsEqual(res, 0.0);
 }
 
-void ExponentialFunction::evaluate(double& res, State const& current,
-                                   ActionState const& actions) const {
+void ExponentialFunction::doEvaluate(double& res, State const& current,
+                                     ActionState const& actions) const {
     expr->evaluate(res, current, actions);
 
     res = std::exp(res);
@@ -197,14 +197,15 @@ void ExponentialFunction::evaluate(double& res, State const& current,
                    Probability Distributions
 *****************************************************************/
 
-void BernoulliDistribution::evaluate(double& /*res*/, State const& /*current*/,
-                                     ActionState const& /*actions*/) const {
+void BernoulliDistribution::doEvaluate(double& /*res*/,
+                                       State const& /*current*/,
+                                       ActionState const& /*actions*/) const {
     SystemUtils::abort(
         "Error: (deterministic) evaluate applied to a probabilistic formula!");
 }
 
-void DiscreteDistribution::evaluate(double& /*res*/, State const& /*current*/,
-                                    ActionState const& /*actions*/) const {
+void DiscreteDistribution::doEvaluate(double& /*res*/, State const& /*current*/,
+                                      ActionState const& /*actions*/) const {
     SystemUtils::abort(
         "Error: (deterministic) evaluate applied to a probabilistic formula!");
 }
@@ -213,8 +214,8 @@ void DiscreteDistribution::evaluate(double& /*res*/, State const& /*current*/,
                          Conditionals
 *****************************************************************/
 
-void MultiConditionChecker::evaluate(double& res, State const& current,
-                                     ActionState const& actions) const {
+void MultiConditionChecker::doEvaluate(double& res, State const& current,
+                                       ActionState const& actions) const {
     for (unsigned int index = 0; index < conditions.size(); ++index) {
         conditions[index]->evaluate(res, current, actions);
 
@@ -1,86 +1,230 @@
-void LogicalExpression::evaluateToPD(DiscretePD& /*res*/,
-                                     State const& /*current*/,
-                                     ActionState const& /*actions*/) const {
+namespace {
+// Evaluating a formula to a probability distribution requires distributions
+// for the results of all subformulas. To avoid that these are allocated in
+// every call, they are taken from a pool that grows with the depth of the
+// formula. Since ScratchPDs are only created as local variables, they are
+// released in reverse order of creation.
+thread_local std::deque<DiscretePD> scratchPDPool;
+thread_local size_t numberOfUsedScratchPDs = 0;
+
+class ScratchPD {
+public:
+    ScratchPD() {
+        if (numberOfUsedScratchPDs == scratchPDPool.size()) {
+            scratchPDPool.emplace_back();
+        }
+        pd = &scratchPDPool[numberOfUsedScratchPDs];
+        ++numberOfUsedScratchPDs;
+        pd->reset();
+    }
+
+    ~ScratchPD() {
+        --numberOfUsedScratchPDs;
+    }
+
+    ScratchPD(ScratchPD const&) = delete;
+    ScratchPD& operator=(ScratchPD const&) = delete;
+
+    DiscretePD& operator*() {
+        return *pd;
+    }
+
+    DiscretePD* operator->() {
+        return pd;
+    }
+
+private:
+    DiscretePD* pd;
+};
+
+// Rounds probabilities that are close to 0 or 1 like assignBernoulli does
+inline double roundTruthProbability(double const& truthProb) {
+    if (MathUtils::doubleIsEqual(truthProb, 0.0)) {
+        return 0.0;
+    } else if (MathUtils::doubleIsEqual(truthProb, 1.0)) {
+        return 1.0;
+    }
+    return truthProb;
+}
+
+// Computes the distribution of op(l, r) for independent l ~ lhs and r ~ rhs.
+// Each outcome of lhs yields a sequence of outcomes that is sorted with
+// sortOutcomes (which is cheap if op is monotonic in r) and merged into res.
+template <typename Op>
+void combinePDs(DiscretePD& res, DiscretePD const& lhs, DiscretePD const& rhs,
+                Op const& op) {
+    ScratchPD outcomes;
+    ScratchPD buffer;
+    res.reset();
+    for (size_t i = 0; i < lhs.values.size(); ++i) {
+        outcomes->reset();
+        for (size_t j = 0; j < rhs.values.size(); ++j) {
+            outcomes->values.push_back(op(lhs.values[i], rhs.values[j]));
+            outcomes->probabilities.push_back(lhs.probabilities[i] *
+                                              rhs.probabilities[j]);
+        }
+        outcomes->sortOutcomes();
+        res.mergeOutcomes(*outcomes, *buffer);
+    }
+}
+
+// Evaluates an arithmetic expression with operands exprs (from left to right)
+template <typename Op>
+void evaluateArithmeticToPD(DiscretePD& res,
+                            std::vector<LogicalExpression*> const& exprs,
+                            State const& current, ActionState const& actions,
+                            Op const& op) {
+    ScratchPD lhs;
+    exprs[0]->evaluateToPD(*lhs, current, actions);
+    assert(lhs->isWellDefined());
+
+    if (exprs.size() == 1) {
+        res = *lhs;
+        return;
+    }
+
+    for (unsigned int index = 1; index < exprs.size(); ++index) {
+        ScratchPD rhs;
+        exprs[index]->evaluateToPD(*rhs, current, actions);
+        assert(rhs->isWellDefined());
+
+        combinePDs(res, *lhs, *rhs, op);
+        if (index + 1 < exprs.size()) {
+            std::swap(*lhs, res);
+        }
+    }
+    assert(res.isWellDefined());
+}
+} // namespace
+
+void LogicalExpression::doEvaluateToPD(DiscretePD& /*res*/,
+                                       State const& /*current*/,
+                                       ActionState const& /*actions*/) const {
     assert(false);
 }
 
+void LogicalExpression::doEvaluateToTruthProbability(
+    double& res, State const& current, ActionState const& actions) const {
+    ScratchPD pd;
+    evaluateToPD(*pd, current, actions);
+    assert(pd->isWellDefined());
+    res = pd->truthProbability();
+}
+
 /*****************************************************************
                            Atomics
 *****************************************************************/
 
-void DeterministicStateFluent::evaluateToPD(
+void DeterministicStateFluent::doEvaluateToPD(
     DiscretePD& res, State const& current,
     ActionState const& /*actions*/) const {
     res.assignDiracDelta(current.deterministicStateFluent(index));
 }
 
-void ProbabilisticStateFluent::evaluateToPD(
+void DeterministicStateFluent::doEvaluateToTruthProbability(
+    double& res, State const& current, ActionState const& /*actions*/) const {
+    res = MathUtils::doubleIsEqual(current.deterministicStateFluent(index), 0.0)
+              ? 0.0
+              : 1.0;
+}
+
+void ProbabilisticStateFluent::doEvaluateToPD(
     DiscretePD& res, State const& current,
     ActionState const& /*actions*/) const {
     res.assignDiracDelta(current.probabilisticStateFluent(index));
 }
 
-void ActionFluent::evaluateToPD(DiscretePD& res, State const& /*current*/,
-                                ActionState const& actions) const {
+void ProbabilisticStateFluent::doEvaluateToTruthProbability(
+    double& res, State const& current, ActionState const& /*actions*/) const {
+    res = MathUtils::doubleIsEqual(current.probabilisticStateFluent(index), 0.0)
+              ? 0.0
+              : 1.0;
+}
+
+void ActionFluent::doEvaluateToPD(DiscretePD& res, State const& /*current*/,
+                                  ActionState const& actions) const {
     res.assignDiracDelta(actions[index]);
 }
 
-void NumericConstant::evaluateToPD(DiscretePD& res, State const& /*current*/,
-                                   ActionState const& /*actions*/) const {
+void ActionFluent::doEvaluateToTruthProbability(
+    double& res, State const& /*current*/, ActionState const& actions) const {
+    res = MathUtils::doubleIsEqual(actions[index], 0.0) ? 0.0 : 1.0;
+}
+
+void NumericConstant::doEvaluateToPD(DiscretePD& res, State const& /*current*/,
+                                     ActionState const& /*actions*/) const {
     res.assignDiracDelta(value);
 }
 
+void NumericConstant::doEvaluateToTruthProbability(
+    double& res, State const& /*current*/,
+    ActionState const& /*actions*/) const {
+    res = MathUtils::doubleIsEqual(value, 0.0) ? 0.0 : 1.0;
+}
+
 /*****************************************************************
                            Connectives
 *****************************************************************/
 
-void Conjunction::evaluateToPD(DiscretePD& res, State const& current,
-                               ActionState const& actions) const {
-    double truthProb = 1.0;
+void Conjunction::doEvaluateToPD(DiscretePD& res, State const& current,
+                                 ActionState const& actions) const {
+    double truthProb = 0.0;
+    evaluateToTruthProbability(truthProb, current, actions);
+    res.assignBernoulli(truthProb);
+}
+
+void Conjunction::doEvaluateToTruthProbability(
+    double& res, State const& current, ActionState const& actions) const {
+    // The operands are independent, so this is the product of their truth
+    // probabilities
+    res = 1.0;
     for (unsigned int i = 0; i < exprs.size(); ++i) {
-        DiscretePD exprRes;
-        exprs[i]->evaluateToPD(exprRes, current, actions);
-        assert(exprRes.isWellDefined());
+        double exprRes = 0.0;
+        exprs[i]->evaluateToTruthProbability(exprRes, current, actions);
 
-        if (exprRes.isFalsity()) {
-            res.assignDiracDelta(0.0);
+        if (exprRes == 0.0) {
+            res = 0.0;
             return;
-        } else {
-            truthProb *= exprRes.truthProbability();
         }
+        res *= exprRes;
     }
+    res = roundTruthProbability(res);
+}
 
+void Disjunction::doEvaluateToPD(DiscretePD& res, State const& current,
+                                 ActionState const& actions) const {
+    double truthProb = 0.0;
+    evaluateToTruthProbability(truthProb, current, actions);
     res.assignBernoulli(truthProb);
 }
 
-void Disjunction::evaluateToPD(DiscretePD& res, State const& current,
-                               ActionState const& actions) const {
+void Disjunction::doEvaluateToTruthProbability(
+    double& res, State const& current, ActionState const& actions) const {
     double falsityProb = 1.0;
     for (unsigned int i = 0; i < exprs.size(); ++i) {
-        DiscretePD exprRes;
-        exprs[i]->evaluateToPD(exprRes, current, actions);
-        assert(exprRes.isWellDefined());
+        double exprRes = 0.0;
+        exprs[i]->evaluateToTruthProbability(exprRes, current, actions);
 
-        if (exprRes.isTruth()) {
-            res.assignDiracDelta(1.0);
+        if (exprRes == 1.0) {
+            res = 1.0;
             return;
-        } else {
-            falsityProb *= exprRes.falsityProbability();
         }
+        falsityProb *= (1.0 - exprRes);
     }
-
-    res.assignBernoulli(1.0 - falsityProb);
+    res = roundTruthProbability(1.0 - falsityProb);
 }
 
-void EqualsExpression::evaluateToPD(DiscretePD& res, State const& current,
-                                    ActionState const& actions) const {
+void EqualsExpression::doEvaluateToPD(DiscretePD& res, State const& current,
+                                      ActionState const& actions) const {
     assert(exprs.size() == 2);
 
-    DiscretePD lhs;
+    ScratchPD lhsPD;
+    DiscretePD& lhs = *lhsPD;
     exprs[0]->evaluateToPD(lhs, current, actions);
     assert(lhs.isWellDefined());
 
-    DiscretePD rhs;
+    ScratchPD rhsPD;
+    DiscretePD& rhs = *rhsPD;
     exprs[1]->evaluateToPD(rhs, current, actions);
     assert(rhs.isWellDefined());
 
@@ -95,15 +239,17 @@ void EqualsExpression::evaluateToPD(DiscretePD& res, State const& current,
     res.assignBernoulli(equalityProb);
 }
 
-void GreaterExpression::evaluateToPD(DiscretePD& res, State const& current,
-                                     ActionState const& actions) const {
+void GreaterExpression::doEvaluateToPD(DiscretePD& res, State const& current,
+                                       ActionState const& actions) const {
     assert(exprs.size() == 2);
 
-    DiscretePD lhs;
+    ScratchPD lhsPD;
+    DiscretePD& lhs = *lhsPD;
     exprs[0]->evaluateToPD(lhs, current, actions);
     assert(lhs.isWellDefined());
 
-    DiscretePD rhs;
+    ScratchPD rhsPD;
+    DiscretePD& rhs = *rhsPD;
     exprs[1]->evaluateToPD(rhs, current, actions);
     assert(rhs.isWellDefined());
 
@@ -121,15 +267,17 @@ void GreaterExpression::evaluateToPD(DiscretePD& res, State const& current,
     res.assignBernoulli(greaterProb);
 }
 
-void LowerExpression::evaluateToPD(DiscretePD& res, State const& current,
-                                   ActionState const& actions) const {
+void LowerExpression::doEvaluateToPD(DiscretePD& res, State const& current,
+                                     ActionState const& actions) const {
     assert(exprs.size() == 2);
 
-    DiscretePD lhs;
+    ScratchPD lhsPD;
+    DiscretePD& lhs = *lhsPD;
     exprs[0]->evaluateToPD(lhs, current, actions);
     assert(lhs.isWellDefined());
 
-    DiscretePD rhs;
+    ScratchPD rhsPD;
+    DiscretePD& rhs = *rhsPD;
     exprs[1]->evaluateToPD(rhs, current, actions);
     assert(rhs.isWellDefined());
 
@@ -147,16 +295,18 @@ void LowerExpression::evaluateToPD(DiscretePD& res, State const& current,
     res.assignBernoulli(lowerProb);
 }
 
-void GreaterEqualsExpression::evaluateToPD(DiscretePD& res,
-                                           State const& current,
-                                           ActionState const& actions) const {
+void GreaterEqualsExpression::doEvaluateToPD(DiscretePD& res,
+                                             State const& current,
+                                             ActionState const& actions) const {
     assert(exprs.size() == 2);
 
-    DiscretePD lhs;
+    ScratchPD lhsPD;
+    DiscretePD& lhs = *lhsPD;
     exprs[0]->evaluateToPD(lhs, current, actions);
     assert(lhs.isWellDefined());
 
-    DiscretePD rhs;
+    ScratchPD rhsPD;
+    DiscretePD& rhs = *rhsPD;
     exprs[1]->evaluateToPD(rhs, current, actions);
     assert(rhs.isWellDefined());
 
@@ -176,15 +326,18 @@ void GreaterEqualsExpression::evaluateToPD(DiscretePD& res,
     res.assignBernoulli(greaterEqualProb);
 }
 
-void LowerEqualsExpression::evaluateToPD(DiscretePD& res, State const& current,
-                                         ActionState const& actions) const {
+void LowerEqualsExpression::doEvaluateToPD(DiscretePD& res,
+                                           State const& current,
+                                           ActionState const& actions) const {
     assert(exprs.size() == 2);
 
-    DiscretePD lhs;
+    ScratchPD lhsPD;
+    DiscretePD& lhs = *lhsPD;
     exprs[0]->evaluateToPD(lhs, current, actions);
     assert(lhs.isWellDefined());
 
-    DiscretePD rhs;
+    ScratchPD rhsPD;
+    DiscretePD& rhs = *rhsPD;
     exprs[1]->evaluateToPD(rhs, current, actions);
     assert(rhs.isWellDefined());
 
@@ -203,129 +356,62 @@ void LowerEqualsExpression::evaluateToPD(DiscretePD& res, State const& current,
     res.assignBernoulli(lowerEqualProb);
 }
 
-void Addition::evaluateToPD(DiscretePD& res, State const& current,
-                            ActionState const& actions) const {
-    exprs[0]->evaluateToPD(res, current, actions);
-    assert(res.isWellDefined());
-
-    for (unsigned int index = 1; index < exprs.size(); ++index) {
-        DiscretePD exprRes;
-        exprs[index]->evaluateToPD(exprRes, current, actions);
-        assert(exprRes.isWellDefined());
-
-        // Merge the results
-        std::map<double, double> valProbPairs;
-        for (unsigned int i = 0; i < res.values.size(); ++i) {
-            for (unsigned int j = 0; j < exprRes.values.size(); ++j) {
-                double val = res.values[i] + exprRes.values[j];
-                if (valProbPairs.find(val) == valProbPairs.end()) {
-                    valProbPairs[val] = 0.0;
-                }
-                valProbPairs[val] +=
-                    (res.probabilities[i] * exprRes.probabilities[j]);
-            }
-        }
-        res.assignDiscrete(valProbPairs);
-    }
-    assert(res.isWellDefined());
+void Addition::doEvaluateToPD(DiscretePD& res, State const& current,
+                              ActionState const& actions) const {
+    evaluateArithmeticToPD(
+        res, exprs, current, actions,
+        [](double const& lhs, double const& rhs) {
+            return lhs + rhs;
+        });
 }
 
-void Subtraction::evaluateToPD(DiscretePD& res, State const& current,
-                               ActionState const& actions) const {
-    exprs[0]->evaluateToPD(res, current, actions);
-    assert(res.isWellDefined());
-
-    for (unsigned int index = 1; index < exprs.size(); ++index) {
-        DiscretePD exprRes;
-        exprs[index]->evaluateToPD(exprRes, current, actions);
-        assert(exprRes.isWellDefined());
-
-        // Merge the results
-        std::map<double, double> valProbPairs;
-        for (unsigned int i = 0; i < res.values.size(); ++i) {
-            for (unsigned int j = 0; j < exprRes.values.size(); ++j) {
-                double val = res.values[i] - exprRes.values[j];
-                if (valProbPairs.find(val) == valProbPairs.end()) {
-                    valProbPairs[val] = 0.0;
-                }
-                valProbPairs[val] +=
-                    (res.probabilities[i] * exprRes.probabilities[j]);
-            }
-        }
-        res.assignDiscrete(valProbPairs);
-    }
-    assert(res.isWellDefined());
+void Subtraction::doEvaluateToPD(DiscretePD& res, State const& current,
+                                 ActionState const& actions) const {
+    evaluateArithmeticToPD(
+        res, exprs, current, actions,
+        [](double const& lhs, double const& rhs) {
+            return lhs - rhs;
+        });
 }
 
-void Multiplication::evaluateToPD(DiscretePD& res, State const& current,
-                                  ActionState const& actions) const {
-    exprs[0]->evaluateToPD(res, current, actions);
-    assert(res.isWellDefined());
-
-    for (unsigned int index = 1; index < exprs.size(); ++index) {
-        DiscretePD exprRes;
-        exprs[index]->evaluateToPD(exprRes, current, actions);
-        assert(exprRes.isWellDefined());
-
-        // Merge the results
-        std::map<double, double> valProbPairs;
-        for (unsigned int i = 0; i < res.values.size(); ++i) {
-            for (unsigned int j = 0; j < exprRes.values.size(); ++j) {
-                double val = res.values[i] * exprRes.values[j];
-                if (valProbPairs.find(val) == valProbPairs.end()) {
-                    valProbPairs[val] = 0.0;
-                }
-                valProbPairs[val] +=
-                    (res.probabilities[i] * exprRes.probabilities[j]);
-            }
-        }
-        res.assignDiscrete(valProbPairs);
-    }
-    assert(res.isWellDefined());
+void Multiplication::doEvaluateToPD(DiscretePD& res, State const& current,
+                                    ActionState const& actions) const {
+    evaluateArithmeticToPD(
+        res, exprs, current, actions,
+        [](double const& lhs, double const& rhs) {
+            return lhs * rhs;
+        });
 }
 
-void Division::evaluateToPD(DiscretePD& res, State const& current,
-                            ActionState const& actions) const {
-    exprs[0]->evaluateToPD(res, current, actions);
-    assert(res.isWellDefined());
-
-    for (unsigned int index = 1; index < exprs.size(); ++index) {
-        DiscretePD exprRes;
-        exprs[index]->evaluateToPD(exprRes, current, actions);
-        assert(exprRes.isWellDefined());
-
-        // Merge the results
-        std::map<double, double> valProbPairs;
-        for (unsigned int i = 0; i < res.values.size(); ++i) {
-            for (unsigned int j = 0; j < exprRes.values.size(); ++j) {
-                assert(!MathUtils::doubleIsEqual(exprRes.values[j], 0.0));
-                double val = res.values[i] / exprRes.values[j];
-                if (valProbPairs.find(val) == valProbPairs.end()) {
-                    valProbPairs[val] = 0.0;
-                }
-                valProbPairs[val] +=
-                    (res.probabilities[i] * exprRes.probabilities[j]);
-            }
-        }
-        res.assignDiscrete(valProbPairs);
-    }
-    assert(res.isWellDefined());
+void Division::doEvaluateToPD(DiscretePD& res, State const& current,
+                              ActionState const& actions) const {
+    evaluateArithmeticToPD(
+        res, exprs, current, actions,
+        [](double const& lhs, double const& rhs) {
+            assert(!MathUtils::doubleIsEqual(rhs, 0.0));
+            return lhs / rhs;
+        });
 }
 
 /*****************************************************************
                           Unaries
 *****************************************************************/
 
-void Negation::evaluateToPD(DiscretePD& res, State const& current,
-                            ActionState const& actions) const {
-    DiscretePD exprRes;
-    expr->evaluateToPD(exprRes, current, actions);
-    assert(exprRes.isWellDefined());
-    res.assignBernoulli(exprRes.falsityProbability());
+void Negation::doEvaluateToPD(DiscretePD& res, State const& current,
+                              ActionState const& actions) const {
+    double truthProb = 0.0;
+    evaluateToTruthProbability(truthProb, current, actions);
+    res.assignBernoulli(truthProb);
 }
 
-void ExponentialFunction::evaluateToPD(DiscretePD& res, State const& current,
-                                       ActionState const& actions) const {
+void Negation::doEvaluateToTruthProbability(double& res, State const& current,
+                                            ActionState const& actions) const {
+    expr->evaluateToTruthProbability(res, current, actions);
+    res = 1.0 - res;
+}
+
+void ExponentialFunction::doEvaluateToPD(DiscretePD& res, State const& current,
+                                         ActionState const& actions) const {
     expr->evaluateToPD(res, current, actions);
 
     for (unsigned int i = 0; i < res.values.size(); ++i) {
@@ -337,43 +423,46 @@ void ExponentialFunction::evaluateToPD(DiscretePD& res, State const& current,
                    Probability Distributions
 *****************************************************************/
 
-void BernoulliDistribution::evaluateToPD(DiscretePD& res, State const& current,
-                                         ActionState const& actions) const {
-    DiscretePD exprRes;
-    expr->evaluateToPD(exprRes, current, actions);
-    assert(exprRes.isWellDefined());
+void BernoulliDistribution::doEvaluateToPD(DiscretePD& res,
+                                           State const& current,
+                                           ActionState const& actions) const {
+    double truthProb = 0.0;
+    evaluateToTruthProbability(truthProb, current, actions);
+    res.assignBernoulli(truthProb);
+}
+
+void BernoulliDistribution::doEvaluateToTruthProbability(
+    double& res, State const& current, ActionState const& actions) const {
+    ScratchPD exprRes;
+    expr->evaluateToPD(*exprRes, current, actions);
+    assert(exprRes->isWellDefined());
 
-    // the expression must evaluateToPD to a real number which is converted to
-    // the
+    // the expression must evaluate to a real number which is converted to the
     // probability that this is true
-    assert(exprRes.isDeterministic());
-    res.assignBernoulli(exprRes.values[0]);
+    assert(exprRes->isDeterministic());
+    res = roundTruthProbability(exprRes->values[0]);
 }
 
-void DiscreteDistribution::evaluateToPD(DiscretePD& res, State const& current,
-                                        ActionState const& actions) const {
-    std::map<double, double> valProbPairs;
+void DiscreteDistribution::doEvaluateToPD(DiscretePD& res, State const& current,
+                                          ActionState const& actions) const {
     res.reset();
+    ScratchPD val;
+    ScratchPD prob;
     for (unsigned int i = 0; i < values.size(); ++i) {
-        DiscretePD val;
-        values[i]->evaluateToPD(val, current, actions);
-
-        DiscretePD prob;
-        probabilities[i]->evaluateToPD(prob, current, actions);
+        values[i]->evaluateToPD(*val, current, actions);
+        probabilities[i]->evaluateToPD(*prob, current, actions);
 
         // Both value and prob must be determinstic
-        assert(val.isDeterministic());
-        assert(prob.isDeterministic());
+        assert(val->isDeterministic());
+        assert(prob->isDeterministic());
 
-        if (MathUtils::doubleIsGreater(prob.values[0], 0.0)) {
-            if (valProbPairs.find(val.values[0]) == valProbPairs.end()) {
-                valProbPairs[val.values[0]] = 0.0;
-            }
-            valProbPairs[val.values[0]] += prob.values[0];
+        if (MathUtils::doubleIsGreater(prob->values[0], 0.0)) {
+            res.values.push_back(val->values[0]);
+            res.probabilities.push_back(prob->values[0]);
         }
     }
 
-    res.assignDiscrete(valProbPairs);
+    res.sortOutcomes();
     assert(res.isWellDefined());
 }
 
@@ -381,38 +470,35 @@ void DiscreteDistribution::evaluateToPD(DiscretePD& res, State const& current,
                          Conditionals
 *****************************************************************/
 
-void MultiConditionChecker::evaluateToPD(DiscretePD& res, State const& current,
-                                         ActionState const& actions) const {
-    std::map<double, double> valProbPairs;
+void MultiConditionChecker::doEvaluateToPD(DiscretePD& res,
+                                           State const& current,
+                                           ActionState const& actions) const {
+    res.reset();
     double remainingProb = 1.0;
+    ScratchPD exprRes;
 
     for (unsigned int index = 0; index < conditions.size(); ++index) {
-        DiscretePD prob;
-        conditions[index]->evaluateToPD(prob, current, actions);
-        assert(prob.isWellDefined());
-
-        if (!prob.isFalsity()) {
-            DiscretePD exprRes;
-            effects[index]->evaluateToPD(exprRes, current, actions);
-            assert(exprRes.isWellDefined());
-
-            for (unsigned int i = 0; i < exprRes.values.size(); ++i) {
-                if (valProbPairs.find(exprRes.values[i]) ==
-                    valProbPairs.end()) {
-                    valProbPairs[exprRes.values[i]] = 0.0;
-                }
-                valProbPairs[exprRes.values[i]] +=
-                    (prob.truthProbability() * remainingProb *
-                     exprRes.probabilities[i]);
+        double truthProb = 0.0;
+        conditions[index]->evaluateToTruthProbability(truthProb, current,
+                                                      actions);
+
+        if (truthProb != 0.0) {
+            effects[index]->evaluateToPD(*exprRes, current, actions);
+            assert(exprRes->isWellDefined());
+
+            for (unsigned int i = 0; i < exprRes->values.size(); ++i) {
+                res.values.push_back(exprRes->values[i]);
+                res.probabilities.push_back(truthProb * remainingProb *
+                                            exprRes->probabilities[i]);
             }
         }
 
-        remainingProb *= prob.falsityProbability();
+        remainingProb *= (1.0 - truthProb);
         if (MathUtils::doubleIsEqual(remainingProb, 0.0)) {
             break;
         }
     }
 
-    res.assignDiscrete(valProbPairs);
+    res.sortOutcomes();
     assert(res.isWellDefined());
 }
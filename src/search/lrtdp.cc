@@ -0,0 +1,536 @@
+#include "lrtdp.h"
+
+#include "utils/logger.h"
+#include "utils/math_utils.h"
+#include "utils/system_utils.h"
+
+using namespace std;
+
+/******************************************************************
+                     Search Engine Creation
+******************************************************************/
+
+LRTDP::LRTDP()
+    : ProbabilisticSearchEngine("LRTDP"),
+      maxNumberOfTrials(0),
+      maxNumberOfOutcomes(1048576),
+      maxNumberOfStateInfos(4194304),
+      numberOfTrials(0),
+      numberOfBackups(0),
+      rootIsSolved(false) {}
+
+bool LRTDP::setValueFromString(string& param, string& value) {
+    if (param == "-r") {
+        setMaxNumberOfTrials(atoi(value.c_str()));
+        return true;
+    } else if (param == "-mo") {
+        setMaxNumberOfOutcomes(atol(value.c_str()));
+        return true;
+    } else if (param == "-mv") {
+        setMaxNumberOfStateInfos(atol(value.c_str()));
+        return true;
+    }
+
+    return SearchEngine::setValueFromString(param, value);
+}
+
+void LRTDP::disableCaching() {
+    SearchEngine::disableCaching();
+    clearStateInfos();
+}
+
+/******************************************************************
+                 Search Engine Administration
+******************************************************************/
+
+void LRTDP::initSession() {
+    // Each backup enumerates all joint outcomes of the probabilistic state
+    // fluents, so we refuse tasks where an action can have too many of them
+    long numberOfOutcomes = 1;
+    for (ProbabilisticCPF const* cpf : probabilisticCPFs) {
+        numberOfOutcomes *= cpf->getDomainSize();
+        if (numberOfOutcomes > maxNumberOfOutcomes) {
+            SystemUtils::abort(
+                "Error: LRTDP is not applicable as an action can have more "
+                "than " +
+                to_string(maxNumberOfOutcomes) +
+                " outcomes (the limit is set with -mo).");
+        }
+    }
+}
+
+/******************************************************************
+                       Main Search Functions
+******************************************************************/
+
+void LRTDP::initStep(State const& /*current*/) {
+    numberOfTrials = 0;
+    numberOfBackups = 0;
+    rootIsSolved = false;
+
+    if (!cachingEnabled && (numberOfStateInfos() > 0)) {
+        clearStateInfos();
+    }
+}
+
+void LRTDP::estimateBestActions(State const& _rootState,
+                                vector<int>& bestActions) {
+    State root = truncateRootState(_rootState);
+    solve(root);
+
+    vector<int> actionsToExpand = getApplicableActions(root);
+    vector<double> qValues(numberOfActions, -numeric_limits<double>::max());
+    vector<bool> isExact(numberOfActions, false);
+    calcQValues(root, actionsToExpand, qValues, isExact);
+
+    // If the root state is solved, an action with an exact Q-value that is
+    // equal to the value of the root state is optimal, while an action whose
+    // Q-value is only an upper bound might have the same estimate
+    double rootValue = 0.0;
+    bool onlyExactActions = false;
+    if (isSolved(root, rootValue)) {
+        for (size_t index = 0; index < qValues.size(); ++index) {
+            if ((actionsToExpand[index] == index) && isExact[index] &&
+                MathUtils::doubleIsEqual(qValues[index], rootValue)) {
+                onlyExactActions = true;
+            }
+        }
+    }
+
+    double stateValue = -numeric_limits<double>::max();
+    for (size_t index = 0; index < qValues.size(); ++index) {
+        if ((actionsToExpand[index] != index) ||
+            (onlyExactActions && !isExact[index])) {
+            continue;
+        }
+        if (MathUtils::doubleIsGreater(qValues[index], stateValue)) {
+            stateValue = qValues[index];
+            bestActions.clear();
+            bestActions.push_back(index);
+        } else if (MathUtils::doubleIsEqual(qValues[index], stateValue)) {
+            bestActions.push_back(index);
+        }
+    }
+}
+
+void LRTDP::estimateQValue(State const& state, int actionIndex,
+                           double& qValue) {
+    assert(state.stepsToGo() > 0);
+    State root = truncateRootState(state);
+    solve(root);
+
+    vector<int> actionsToExpand(numberOfActions, -1);
+    actionsToExpand[actionIndex] = actionIndex;
+    vector<double> qValues(numberOfActions, -numeric_limits<double>::max());
+    vector<bool> isExact(numberOfActions, false);
+    calcQValues(root, actionsToExpand, qValues, isExact);
+    qValue = qValues[actionIndex];
+}
+
+void LRTDP::estimateQValues(State const& _rootState,
+                            vector<int> const& actionsToExpand,
+                            vector<double>& qValues) {
+    assert(_rootState.stepsToGo() > 0);
+    assert(qValues.size() == SearchEngine::numberOfActions);
+    State root = truncateRootState(_rootState);
+    solve(root);
+
+    vector<bool> isExact(numberOfActions, false);
+    calcQValues(root, actionsToExpand, qValues, isExact);
+}
+
+State LRTDP::truncateRootState(State const& _rootState) const {
+    State root(_rootState);
+    if (root.stepsToGo() > maxSearchDepth) {
+        root.stepsToGo() = maxSearchDepth;
+    }
+    return root;
+}
+
+void LRTDP::solve(State const& root) {
+    stopwatch.reset();
+
+    double rootValue = 0.0;
+    int trials = 0;
+    while (!isSolved(root, rootValue) && !terminate(trials)) {
+        // The values of states that are not in the table are initialized
+        // with an upper bound again, so it can be cleared at any time
+        if (numberOfStateInfos() > maxNumberOfStateInfos) {
+            clearStateInfos();
+        }
+        trial(root);
+        ++trials;
+    }
+    numberOfTrials += trials;
+    rootIsSolved = isSolved(root, rootValue);
+}
+
+bool LRTDP::terminate(int const& trials) const {
+    if (trials == 0) {
+        return false;
+    }
+    if ((maxNumberOfTrials > 0) && (trials >= maxNumberOfTrials)) {
+        return true;
+    }
+    return timeIsUp();
+}
+
+bool LRTDP::timeIsUp() const {
+    return MathUtils::doubleIsGreater(stopwatch(), timeout);
+}
+
+void LRTDP::trial(State const& root) {
+    trialStates.clear();
+    State current(root);
+    PDState next(root.stepsToGo() - 1);
+    double value = 0.0;
+
+    while (!isSolved(current, value)) {
+        if (!findStateInfo(current) && isARewardLock(current)) {
+            // This state is a reward lock, i.e. a goal or a state that is such
+            // that no matter which action is applied we'll always get the same
+            // reward
+            double reward = 0.0;
+            calcReward(current, 0, reward);
+            markSolved(current, reward * current.stepsToGo());
+            break;
+        }
+
+        trialStates.push_back(current);
+        int actionIndex = update(current);
+        next.reset(current.stepsToGo() - 1);
+        sampleSuccessorState(current, actionIndex, next);
+        current.setTo(next);
+
+        // Backups can be expensive, so the timeout is also checked within a
+        // trial. The visited states are not labeled in that case.
+        if (timeIsUp()) {
+            return;
+        }
+    }
+
+    // Label the visited states in reverse order
+    while (!trialStates.empty()) {
+        if (!checkSolved(trialStates.back())) {
+            break;
+        }
+        trialStates.pop_back();
+    }
+}
+
+bool LRTDP::checkSolved(State const& state) {
+    double value = 0.0;
+    if (isSolved(state, value)) {
+        return true;
+    }
+
+    bool result = true;
+    // The states themselves are needed to compute their Q-values, but
+    // reached states are only identified by their key if possible
+    vector<State> open(1, state);
+    vector<State> closed;
+    StateKeyHashSet reachedKeys;
+    StateHashSet reachedStates;
+    auto reach = [&](State const& s) {
+        if (State::stateHashingPossible) {
+            return reachedKeys.insert(getStateKey(s)).second;
+        }
+        return reachedStates.insert(s).second;
+    };
+    reach(state);
+
+    vector<pair<State, double>> outcomes;
+    vector<double> qValues(numberOfActions);
+    vector<bool> isExact(numberOfActions);
+    while (!open.empty()) {
+        if (timeIsUp()) {
+            // The values of all states are still upper bounds, so we can stop
+            // without labeling or updating them
+            return false;
+        }
+        closed.push_back(open.back());
+        open.pop_back();
+        State const& current = closed.back();
+
+        isSolved(current, value);
+        vector<int> actionsToExpand = getApplicableActions(current);
+        calcQValues(current, actionsToExpand, qValues, isExact);
+        int actionIndex = getGreedyActionIndex(actionsToExpand, qValues);
+        if (!MathUtils::doubleIsEqual(value, qValues[actionIndex])) {
+            // The value has not converged, so we don't look at the states
+            // below this one
+            result = false;
+            continue;
+        }
+
+        outcomes.clear();
+        calcOutcomes(current, actionIndex, outcomes);
+        for (pair<State, double> const& outcome : outcomes) {
+            double outcomeValue = 0.0;
+            if (!isSolved(outcome.first, outcomeValue) &&
+                reach(outcome.first)) {
+                open.push_back(outcome.first);
+            }
+        }
+    }
+
+    if (result) {
+        for (State const& current : closed) {
+            isSolved(current, value);
+            markSolved(current, value);
+        }
+    } else {
+        while (!closed.empty()) {
+            update(closed.back());
+            closed.pop_back();
+        }
+    }
+    return result;
+}
+
+int LRTDP::update(State const& state) {
+    vector<int> actionsToExpand = getApplicableActions(state);
+    vector<double> qValues(numberOfActions, -numeric_limits<double>::max());
+    vector<bool> isExact(numberOfActions, false);
+    calcQValues(state, actionsToExpand, qValues, isExact);
+    int actionIndex = getGreedyActionIndex(actionsToExpand, qValues);
+    ++numberOfBackups;
+
+    // All other Q-values are upper bounds that are not higher, so the state
+    // is solved if the Q-value of the greedy action is exact
+    if (isExact[actionIndex]) {
+        markSolved(state, qValues[actionIndex]);
+        return actionIndex;
+    }
+
+    insertStateInfo(state, StateInfo(qValues[actionIndex], false)).value =
+        qValues[actionIndex];
+    return actionIndex;
+}
+
+/******************************************************************
+                        State Values
+******************************************************************/
+
+bool LRTDP::isSolved(State const& state, double& value) const {
+    if (state.stepsToGo() == 0) {
+        value = 0.0;
+        return true;
+    } else if (state.stepsToGo() == 1) {
+        calcOptimalFinalReward(state, value);
+        return true;
+    }
+
+    StateInfo const* info = findStateInfo(state);
+    if (info) {
+        value = info->value;
+        return info->solved;
+    }
+
+    {
+        CacheLock lock(ProbabilisticSearchEngine::cacheMutex);
+        StateValueHashMap::const_iterator cacheIt =
+            ProbabilisticSearchEngine::stateValueCache.find(state);
+        if (cacheIt != ProbabilisticSearchEngine::stateValueCache.end()) {
+            value = cacheIt->second;
+            return true;
+        }
+    }
+
+    // The state has not been visited, so we use an upper bound
+    calcOptimalFinalReward(state, value);
+    value += static_cast<double>(state.stepsToGo() - 1) *
+             SearchEngine::rewardCPF->getMaxVal();
+    return false;
+}
+
+void LRTDP::markSolved(State const& state, double const& value) {
+    if (cachingEnabled) {
+        {
+            CacheLock lock(ProbabilisticSearchEngine::cacheMutex);
+            ProbabilisticSearchEngine::stateValueCache[state] = value;
+        }
+        eraseStateInfo(state);
+    } else {
+        insertStateInfo(state, StateInfo(value, true)) = StateInfo(value, true);
+    }
+}
+
+LRTDP::StateInfo const* LRTDP::findStateInfo(State const& state) const {
+    if (State::stateHashingPossible) {
+        StateKeyInfoHashMap::const_iterator it =
+            stateKeyInfos.find(getStateKey(state));
+        return (it != stateKeyInfos.end()) ? &(it->second) : nullptr;
+    }
+    StateInfoHashMap::const_iterator it = stateInfos.find(state);
+    return (it != stateInfos.end()) ? &(it->second) : nullptr;
+}
+
+LRTDP::StateInfo& LRTDP::insertStateInfo(State const& state,
+                                         StateInfo const& info) {
+    if (State::stateHashingPossible) {
+        return stateKeyInfos.emplace(getStateKey(state), info).first->second;
+    }
+    return stateInfos.emplace(state, info).first->second;
+}
+
+void LRTDP::eraseStateInfo(State const& state) {
+    if (State::stateHashingPossible) {
+        stateKeyInfos.erase(getStateKey(state));
+    } else {
+        stateInfos.erase(state);
+    }
+}
+
+void LRTDP::clearStateInfos() {
+    StateKeyInfoHashMap tmpKeyInfos;
+    stateKeyInfos.swap(tmpKeyInfos);
+    StateInfoHashMap tmpInfos;
+    stateInfos.swap(tmpInfos);
+}
+
+size_t LRTDP::numberOfStateInfos() const {
+    return stateKeyInfos.size() + stateInfos.size();
+}
+
+void LRTDP::calcQValues(State const& state, vector<int> const& actionsToExpand,
+                        vector<double>& qValues, vector<bool>& isExact) const {
+    // The successor of the first applicable action is the base for the
+    // computation of all other successors
+    PDState base(state.stepsToGo() - 1);
+    PDState next(state.stepsToGo() - 1);
+    int baseActionIndex = -1;
+
+    vector<pair<State, double>> outcomes;
+    for (size_t index = 0; index < actionsToExpand.size(); ++index) {
+        if (actionsToExpand[index] != index) {
+            continue;
+        }
+
+        PDState* successor = &next;
+        if (baseActionIndex < 0) {
+            calcSuccessorState(state, index, base);
+            baseActionIndex = index;
+            successor = &base;
+        } else {
+            next.reset(state.stepsToGo() - 1);
+            calcSuccessorState(state, index, base, baseActionIndex, next);
+        }
+
+        outcomes.clear();
+        addOutcomes(*successor, 0, 1.0, outcomes);
+
+        calcReward(state, index, qValues[index]);
+        isExact[index] = true;
+        for (pair<State, double> const& outcome : outcomes) {
+            double value = 0.0;
+            if (!isSolved(outcome.first, value)) {
+                isExact[index] = false;
+            }
+            qValues[index] += outcome.second * value;
+        }
+    }
+}
+
+int LRTDP::getGreedyActionIndex(vector<int> const& actionsToExpand,
+                                vector<double> const& qValues) const {
+    int result = -1;
+    for (size_t index = 0; index < actionsToExpand.size(); ++index) {
+        if ((actionsToExpand[index] == index) &&
+            ((result < 0) ||
+             MathUtils::doubleIsGreater(qValues[index], qValues[result]))) {
+            result = index;
+        }
+    }
+    assert(result >= 0);
+    return result;
+}
+
+/******************************************************************
+                        State Transitions
+******************************************************************/
+
+void LRTDP::calcOutcomes(State const& state, int const& actionIndex,
+                         vector<pair<State, double>>& outcomes) const {
+    PDState next(state.stepsToGo() - 1);
+    calcSuccessorState(state, actionIndex, next);
+    addOutcomes(next, 0, 1.0, outcomes);
+}
+
+void LRTDP::addOutcomes(PDState& next, int varIndex, double prob,
+                        vector<pair<State, double>>& outcomes) const {
+    if (varIndex == State::numberOfProbabilisticStateFluents) {
+        // The state fluent hash keys are computed on the copy as they are
+        // added up (i.e., they must be 0 in next)
+        outcomes.emplace_back(next, prob);
+        State& outcome = outcomes.back().first;
+        State::calcStateFluentHashKeys(outcome);
+        State::calcStateHashKey(outcome);
+        return;
+    }
+
+    DiscretePD const& pd = next.probabilisticStateFluentAsPD(varIndex);
+    for (size_t i = 0; i < pd.values.size(); ++i) {
+        next.probabilisticStateFluent(varIndex) = pd.values[i];
+        addOutcomes(next, varIndex + 1, prob * pd.probabilities[i], outcomes);
+    }
+}
+
+void LRTDP::sampleSuccessorState(State const& current, int const& actionIndex,
+                                 PDState& next) const {
+    calcSuccessorState(current, actionIndex, next);
+    for (unsigned int varIndex = 0;
+         varIndex < State::numberOfProbabilisticStateFluents; ++varIndex) {
+        next.sample(varIndex);
+    }
+    State::calcStateFluentHashKeys(next);
+    State::calcStateHashKey(next);
+}
+
+/******************************************************************
+                            Print
+******************************************************************/
+
+void LRTDP::printConfig(string indent) const {
+    SearchEngine::printConfig(indent);
+    indent += "  ";
+
+    Logger::logLine(
+        indent + "Max number of trials: " + to_string(maxNumberOfTrials),
+        Verbosity::VERBOSE);
+    Logger::logLine(
+        indent + "Max number of outcomes: " + to_string(maxNumberOfOutcomes),
+        Verbosity::VERBOSE);
+    Logger::logLine(indent + "Max number of entries in value table: " +
+                        to_string(maxNumberOfStateInfos),
+                    Verbosity::VERBOSE);
+}
+
+void LRTDP::printRoundStatistics(string indent) const {
+    Logger::logLine(indent + name + " round statistics:", Verbosity::NORMAL);
+    indent += "  ";
+
+    Logger::logLine(
+        indent + "Entries in value table: " + to_string(numberOfStateInfos()),
+        Verbosity::NORMAL);
+    printStateValueCacheUsage(indent, Verbosity::NORMAL);
+}
+
+void LRTDP::printStepStatistics(string indent) const {
+    Logger::logLine(indent + name + " step statistics:", Verbosity::NORMAL);
+    indent += "  ";
+
+    Logger::logLine(indent + "Performed trials: " + to_string(numberOfTrials),
+                    Verbosity::NORMAL);
+    Logger::logLine(indent + "Performed backups: " + to_string(numberOfBackups),
+                    Verbosity::NORMAL);
+    if (rootIsSolved) {
+        Logger::logLine(indent + "Root state solved: yes", Verbosity::NORMAL);
+    } else {
+        Logger::logLine(indent + "Root state solved: no", Verbosity::NORMAL);
+    }
+    Logger::logLine(
+        indent + "Entries in value table: " + to_string(numberOfStateInfos()),
+        Verbosity::VERBOSE);
+    printStateValueCacheUsage(indent);
+}
@@ -0,0 +1,215 @@
+#ifndef LRTDP_H
+#define LRTDP_H
+
+// Implements Labeled RTDP (Bonet and Geffner, 2003) for finite horizon MDPs.
+// Each trial follows the greedy action of the visited states (with sampled
+// outcomes) until a solved state is reached and updates the value of each
+// visited state with a Bellman backup over the full distribution of successor
+// states. Afterwards, the visited states are checked in reverse order: a state
+// is labeled as solved if the values of all unsolved states that are
+// reachable under greedy actions have converged.
+//
+// Unvisited states are initialized with an upper bound on their value (the
+// optimal final reward plus the maximal reward in all other steps), such that
+// the value of a solved state is exact. As the remaining steps are part of a
+// state, the task is acyclic, and all states with a single remaining step are
+// solved right away.
+//
+// Values are kept in a hash table of visited states rather than in a tree, so
+// states that are reached on several paths are stored once. If perfect state
+// hash keys exist, a state is identified by its hash key and its remaining
+// steps in that table, and otherwise by a copy of the state. If caching is
+// enabled, solved states are moved from that table to the state value cache,
+// where they are available to later steps, rounds and other search engines.
+// Otherwise, the table is cleared in each step. In both cases, the table is
+// cleared if it exceeds a maximal number of entries.
+
+#include "search_engine.h"
+
+#include "utils/stopwatch.h"
+
+#include <unordered_set>
+
+class LRTDP : public ProbabilisticSearchEngine {
+public:
+    LRTDP();
+
+    // Set parameters from command line
+    bool setValueFromString(std::string& param, std::string& value) override;
+
+    // This is called when caching is disabled because memory becomes sparse
+    void disableCaching() override;
+
+    // Notify the search engine that the session starts
+    void initSession() override;
+
+    // Notify the search engine that a new step starts
+    void initStep(State const& current) override;
+
+    // Start the search engine to calculate best actions
+    void estimateBestActions(State const& _rootState,
+                             std::vector<int>& bestActions) override;
+
+    // Start the search engine to estimate the Q-value of a single action
+    void estimateQValue(State const& state, int actionIndex,
+                        double& qValue) override;
+
+    // Start the search engine to estimate the Q-values of all applicable
+    // actions
+    void estimateQValues(State const& _rootState,
+                         std::vector<int> const& actionsToExpand,
+                         std::vector<double>& qValues) override;
+
+    // Parameter Setter
+    virtual void setMaxNumberOfTrials(int _maxNumberOfTrials) {
+        maxNumberOfTrials = _maxNumberOfTrials;
+    }
+
+    virtual void setMaxNumberOfOutcomes(long _maxNumberOfOutcomes) {
+        maxNumberOfOutcomes = _maxNumberOfOutcomes;
+    }
+
+    virtual void setMaxNumberOfStateInfos(long _maxNumberOfStateInfos) {
+        maxNumberOfStateInfos = _maxNumberOfStateInfos;
+    }
+
+    // Print
+    void printConfig(std::string indent) const override;
+    void printRoundStatistics(std::string indent) const override;
+    void printStepStatistics(std::string indent) const override;
+
+private:
+    // The value of a visited state and whether it is solved
+    struct StateInfo {
+        StateInfo(double _value, bool _solved)
+            : value(_value), solved(_solved) {}
+
+        double value;
+        bool solved;
+    };
+
+    typedef std::unordered_map<State, StateInfo, State::HashWithRemSteps,
+                               State::EqualWithRemSteps>
+        StateInfoHashMap;
+    typedef std::unordered_set<State, State::HashWithRemSteps,
+                               State::EqualWithRemSteps>
+        StateHashSet;
+
+    // The hash key and the remaining steps of a state (only used if perfect
+    // state hash keys exist)
+    typedef std::pair<long, int> StateKey;
+    struct HashStateKey {
+        size_t operator()(StateKey const& key) const {
+            return static_cast<size_t>(key.first) * 31 + key.second;
+        }
+    };
+    typedef std::unordered_map<StateKey, StateInfo, HashStateKey>
+        StateKeyInfoHashMap;
+    typedef std::unordered_set<StateKey, HashStateKey> StateKeyHashSet;
+
+    static StateKey getStateKey(State const& state) {
+        assert(State::stateHashingPossible && (state.hashKey >= 0));
+        return StateKey(state.hashKey, state.stepsToGo());
+    }
+
+    // Performs trials from root until root is solved or the search terminates
+    void solve(State const& root);
+
+    // Performs a single trial from root
+    void trial(State const& root);
+
+    // Labels state and all unsolved states that are reachable under greedy
+    // actions as solved if their values have converged, and updates them
+    // otherwise. Returns true if state is solved afterwards.
+    bool checkSolved(State const& state);
+
+    // Updates the value of state with a Bellman backup and returns the index
+    // of the greedy action
+    int update(State const& state);
+
+    // Returns true if state is solved and writes its value (or the initial
+    // upper bound if it has not been visited) to value
+    bool isSolved(State const& state, double& value) const;
+
+    // Stores the value of solved state
+    void markSolved(State const& state, double const& value);
+
+    // Returns the entry of state in the value table, or nullptr if there is
+    // none
+    StateInfo const* findStateInfo(State const& state) const;
+
+    // Returns the entry of state in the value table, which is created from
+    // info if there is none
+    StateInfo& insertStateInfo(State const& state, StateInfo const& info);
+
+    // Removes the entry of state from the value table
+    void eraseStateInfo(State const& state);
+
+    // Removes all entries from the value table and releases its memory
+    void clearStateInfos();
+
+    // Returns the number of entries in the value table
+    size_t numberOfStateInfos() const;
+
+    // Computes the Q-values of all applicable and reasonable actions in state.
+    // isExact[i] is true if all outcomes of the action with index i are
+    // solved, i.e., if qValues[i] is the optimal Q-value.
+    void calcQValues(State const& state,
+                     std::vector<int> const& actionsToExpand,
+                     std::vector<double>& qValues,
+                     std::vector<bool>& isExact) const;
+
+    // Returns the index of the action with the highest Q-value (of the ones
+    // that are applicable and reasonable)
+    int getGreedyActionIndex(std::vector<int> const& actionsToExpand,
+                             std::vector<double> const& qValues) const;
+
+    // Computes the outcomes of applying the action with index actionIndex to
+    // state (with their probabilities)
+    void calcOutcomes(State const& state, int const& actionIndex,
+                      std::vector<std::pair<State, double>>& outcomes) const;
+
+    // Adds all outcomes of next where the probabilistic state fluents from
+    // varIndex on are not fixed yet to outcomes
+    void addOutcomes(PDState& next, int varIndex, double prob,
+                     std::vector<std::pair<State, double>>& outcomes) const;
+
+    // Samples a successor of applying the action with index actionIndex to
+    // current
+    void sampleSuccessorState(State const& current, int const& actionIndex,
+                              PDState& next) const;
+
+    // Returns true if the search must be terminated after the given number of
+    // trials
+    bool terminate(int const& trials) const;
+
+    // Returns true if the time of the current step is up
+    bool timeIsUp() const;
+
+    // Returns root with at most maxSearchDepth remaining steps
+    State truncateRootState(State const& _rootState) const;
+
+    // Parameter
+    int maxNumberOfTrials;
+    long maxNumberOfOutcomes;
+    long maxNumberOfStateInfos;
+
+    // The values of visited states that have not been moved to the state
+    // value cache (stateKeyInfos is used if perfect state hash keys exist,
+    // and stateInfos otherwise)
+    StateKeyInfoHashMap stateKeyInfos;
+    StateInfoHashMap stateInfos;
+
+    // The states that are visited in the current trial
+    std::vector<State> trialStates;
+
+    // Is used for the timeout check
+    Stopwatch stopwatch;
+
+    // Statistics
+    long numberOfTrials;
+    long numberOfBackups;
+    bool rootIsSolved;
+};
+
+#endif
@@ -39,6 +39,42 @@ void printUsage() {
          << endl;
     cout << "    Default: sizeof(long)*8" << endl << endl;
 
+    cout << "  -tm <NONE | UNI | ADA>" << endl;
+    cout << "    Specifies how the remaining time is distributed among the "
+         << endl
+         << "    steps. UNI assigns the same share to all remaining steps. ADA "
+         << endl
+         << "    additionally banks the time a step does not use (e.g., if "
+         << endl
+         << "    the search engine terminates early) and reallocates it to "
+         << endl
+         << "    the remaining steps of the round." << endl;
+    cout << "    Default: NONE" << endl << endl;
+
+    cout << "  -cache <file>" << endl;
+    cout << "    Specifies a file where the content of caches that are "
+         << endl
+         << "    independent from the search engine is stored at the end of "
+         << endl
+         << "    the session. If the file contains the caches of an earlier "
+         << endl
+         << "    run on the same parser output, they are loaded in the "
+         << endl
+         << "    beginning of the session." << endl;
+    cout << "    Default: None (caches are not stored)" << endl << endl;
+
+    cout << "  -rls <int>" << endl;
+    cout << "    Specifies the maximal number of transitions (pairs of a "
+         << endl
+         << "    state and an action) such that all dead ends and goals are "
+         << endl
+         << "    computed at the beginning of the session if reward locks are "
+         << endl
+         << "    cached. Reward lock detection is then a lookup. 0 disables "
+         << endl
+         << "    the precomputation." << endl;
+    cout << "    Default: 1048576" << endl << endl;
+
     cout << "  -se <SearchEngine>" << endl;
     cout << "    Specifies the used main search engine." << endl;
     cout << "    MANDATORY." << endl << endl << endl;
@@ -92,6 +128,31 @@ void printUsage() {
          << endl;
     cout << "    Default: 1" << endl << endl;
 
+    cout << "  -lthreads <int>" << endl;
+    cout << "    Specifies the number of threads that perform IDS on the "
+            "training set simultaneously when the search depth is learned. "
+            "The time of each run is measured as CPU time of its thread, such "
+            "that the learned search depth does not depend on the number of "
+            "threads."
+         << endl;
+    cout << "    Default: 1" << endl << endl;
+
+    cout << "  -dfs-threads <int>" << endl;
+    cout << "    Specifies the number of threads that are used by the depth "
+            "first search of each iteration. The applicable actions in the "
+            "root state are evaluated simultaneously, and the state value "
+            "cache is shared among all threads."
+         << endl;
+    cout << "    Default: 1" << endl << endl;
+
+    cout << "  -bb <0|1>" << endl;
+    cout << "    Specifies if the depth first search of each iteration uses "
+            "branch and bound: successors are ordered by immediate reward, "
+            "and actions whose immediate reward plus the maximal reward of "
+            "all remaining steps cannot beat the best action are skipped."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
     cout << "  -minsd <int>" << endl;
     cout << "    Specifies the minimal search depth we expect from learning. "
             "If learning determines a lower search depth than this, it is set "
@@ -146,6 +207,57 @@ void printUsage() {
          << endl;
     cout << "    Default: 1" << endl << endl;
 
+    cout << "************************* LRTDP **************************"
+         << endl;
+
+    cout << "LRTDP is an implementation of Labeled RTDP (Bonet and Geffner, "
+            "2003). Its trials follow greedy actions and perform full Bellman "
+            "backups, and states whose values have converged are labeled as "
+            "solved. Values are stored in a table of states (and not in a "
+            "tree), and the values of solved states are kept for later steps "
+            "in the cache of solved states. It is created by [LRTDP "
+            "<options>] with the following options:"
+         << endl
+         << endl;
+
+    cout << "  -t <double>" << endl;
+    cout << "    Specifies the timeout in seconds of each step (if the "
+            "timeout is not managed by the planner)."
+         << endl;
+    cout << "    Default: 1.0" << endl << endl;
+
+    cout << "  -r <int>" << endl;
+    cout << "    Specifies the maximal number of trials in each step, where 0 "
+            "means that only the timeout terminates the search (unless the "
+            "current state is solved)."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  -mo <int>" << endl;
+    cout << "    Specifies the maximal number of outcomes of an action. As "
+            "LRTDP enumerates all outcomes in each backup, the planner is "
+            "aborted if an action can have more outcomes."
+         << endl;
+    cout << "    Default: 1048576" << endl << endl;
+
+    cout << "  -mv <int>" << endl;
+    cout << "    Specifies the maximal number of entries in the table of "
+            "values of visited states. The table is cleared before a trial if "
+            "it is larger."
+         << endl;
+    cout << "    Default: 4194304" << endl << endl;
+
+    cout << "  -sd <int>" << endl;
+    cout << "    Specifies the maximal search depth." << endl;
+    cout << "    Default: horizon" << endl << endl;
+
+    cout << "  -uc <0|1>" << endl;
+    cout << "    Specifies if caching is used. If this is switched on, we keep "
+            "track of the memory and stop caching once a critical amount of "
+            "memory is used."
+         << endl;
+    cout << "    Default: 1" << endl << endl;
+
     cout << "************************** THTS **************************"
          << endl;
 
@@ -217,6 +329,75 @@ void printUsage() {
          << endl;
     cout << "    Default: 24000000" << endl << endl;
 
+    cout << "  -tree-mem <int>[K|M|G]" << endl;
+    cout << "    Specifies the memory budget of the search tree (in KB if no "
+            "unit is given), which is shared among all threads. If the budget "
+            "is reached, trials continue to update the existing nodes, but "
+            "end where they would create a new node."
+         << endl;
+    cout << "    Default: unlimited" << endl << endl;
+
+    cout << "  -stable <double>" << endl;
+    cout << "    If set to a value larger than 0, the search terminates early "
+            "once the action with the highest estimate in the root node has "
+            "been selected in at least this share of all trials (which is "
+            "checked every 100 trials)."
+         << endl;
+    cout << "    Default: 0 (disabled)" << endl << endl;
+
+    cout << "  -threads <int>" << endl;
+    cout << "    Specifies the number of threads that are used by the THTS "
+            "algorithm. Each thread builds its own search tree from the "
+            "current state, and the recommendation is based on the combined "
+            "root nodes of all trees. The maximal number of search nodes is "
+            "shared among all trees."
+         << endl;
+    cout << "    Default: 1" << endl << endl;
+
+    cout << "  -shared-tree <0|1>" << endl;
+    cout << "    If set to 1 and more than one thread is used, all threads "
+            "perform trials in the same search tree. Node statistics are "
+            "updated atomically, and a virtual loss in UCB1 action selection "
+            "keeps threads from simultaneously exploring the same actions."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  -joint-outcomes <0|1>" << endl;
+    cout << "    If set to 1, the outcome of an action is sampled for all "
+            "probabilistic state fluents at once, and the successor decision "
+            "node is looked up by the hash key of its state instead of "
+            "descending one chance node per state fluent. The outcome "
+            "selection is not used in this case, and it cannot be combined "
+            "with -shared-tree 1."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  -batch <int>" << endl;
+    cout << "    If set to a value larger than 1, trials end in the first "
+            "node that must be initialized, and the initialization is "
+            "deferred until that many trials wait for it. The nodes of a batch "
+            "are then initialized simultaneously by all threads, i.e., the "
+            "threads evaluate the heuristic instead of searching in trees of "
+            "their own. Cannot be combined with -shared-tree 1 or with -reuse "
+            "1 if more than one thread is used."
+         << endl;
+    cout << "    Default: 1" << endl << endl;
+
+    cout << "  -reuse <0|1>" << endl;
+    cout << "    If set to 1, the subtree below the executed action and the "
+            "observed outcome is kept as search tree of the next step instead "
+            "of starting from scratch. Cannot be combined with -shared-tree 1."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
+    cout << "  -transpositions <0|1>" << endl;
+    cout << "    If set to 1, decision nodes that represent the same state with "
+            "the same number of remaining steps share their children, i.e., "
+            "the search tree becomes a directed acyclic graph and each state "
+            "is initialized only once per step."
+         << endl;
+    cout << "    Default: 0" << endl << endl;
+
     cout << "  -sd <int>" << endl;
     cout << "    Specifies the considered horizon." << endl;
     cout << "    Default: Horizon of the task" << endl << endl;
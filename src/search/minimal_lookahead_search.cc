@@ -2,9 +2,13 @@
 
 #include "utils/logger.h"
 
+#include <algorithm>
+
 using namespace std;
 
 MinimalLookaheadSearch::HashMap MinimalLookaheadSearch::rewardCache;
+vector<double> MinimalLookaheadSearch::rewardCacheTable;
+std::mutex MinimalLookaheadSearch::rewardCacheMutex;
 
 MinimalLookaheadSearch::MinimalLookaheadSearch()
     : DeterministicSearchEngine("MLS"),
@@ -18,13 +22,21 @@ MinimalLookaheadSearch::MinimalLookaheadSearch()
 
 void MinimalLookaheadSearch::estimateQValue(State const& state, int actionIndex,
                                             double& qValue) {
-    HashMap::iterator it = rewardCache.find(state);
+    bool isCached = false;
+    {
+        CacheLock lock(rewardCacheMutex);
+        HashMap::const_iterator it = rewardCache.find(state);
+        if (it != rewardCache.end() &&
+            !MathUtils::doubleIsMinusInfinity(
+                rewardCacheTable[it->second + actionIndex])) {
+            qValue = rewardCacheTable[it->second + actionIndex] *
+                     (double)state.stepsToGo();
+            isCached = true;
+        }
+    }
 
-    if (it != rewardCache.end() &&
-        !MathUtils::doubleIsMinusInfinity(it->second[actionIndex])) {
+    if (isCached) {
         ++cacheHits;
-        qValue = it->second[actionIndex] * (double)state.stepsToGo();
-        ;
     } else {
         // Apply the action to state
         calcReward(state, actionIndex, qValue);
@@ -45,12 +57,8 @@ void MinimalLookaheadSearch::estimateQValue(State const& state, int actionIndex,
         }
 
         if (cachingEnabled) {
-            if (it == rewardCache.end()) {
-                rewardCache[state] =
-                    vector<double>(SearchEngine::numberOfActions,
-                                   -std::numeric_limits<double>::max());
-            }
-            rewardCache[state][actionIndex] = qValue;
+            CacheLock lock(rewardCacheMutex);
+            rewardCacheTable[getRewardCacheRow(state) + actionIndex] = qValue;
         }
         qValue *= (double)state.stepsToGo();
 
@@ -61,18 +69,26 @@ void MinimalLookaheadSearch::estimateQValue(State const& state, int actionIndex,
 void MinimalLookaheadSearch::estimateQValues(State const& state,
                                              vector<int> const& actionsToExpand,
                                              vector<double>& qValues) {
-    HashMap::iterator it = rewardCache.find(state);
-
-    if (it != rewardCache.end()) {
-        ++cacheHits;
-        assert(qValues.size() == it->second.size());
-        for (size_t index = 0; index < qValues.size(); ++index) {
-            if (actionsToExpand[index] == index) {
-                qValues[index] = it->second[index] * (double)state.stepsToGo();
-            } else {
-                qValues[index] = -std::numeric_limits<double>::max();
+    bool isCached = false;
+    {
+        CacheLock lock(rewardCacheMutex);
+        HashMap::const_iterator it = rewardCache.find(state);
+        if (it != rewardCache.end()) {
+            assert(qValues.size() == SearchEngine::numberOfActions);
+            for (size_t index = 0; index < qValues.size(); ++index) {
+                if (actionsToExpand[index] == index) {
+                    qValues[index] = rewardCacheTable[it->second + index] *
+                                     (double)state.stepsToGo();
+                } else {
+                    qValues[index] = -std::numeric_limits<double>::max();
+                }
             }
+            isCached = true;
         }
+    }
+
+    if (isCached) {
+        ++cacheHits;
     } else {
         if (rewardCPF->isActionIndependent()) {
             // Calculate the reward in state. It doesn't matter which action we
@@ -82,12 +98,25 @@ void MinimalLookaheadSearch::estimateQValues(State const& state,
             double reward = 0.0;
             calcReward(state, 0, reward);
 
+            // Successors are computed incrementally from the successor under
+            // the first expanded action, and all are computed in the same
+            // buffer
+            State base;
+            State next;
+            int baseActionIndex = -1;
             for (size_t index = 0; index < actionsToExpand.size(); ++index) {
                 if (actionsToExpand[index] == index) {
                     // Calculate the successor state given this action is
                     // applied (i.e., the action matters here!)
-                    State next;
-                    calcSuccessorState(state, index, next);
+                    next.reset(state.stepsToGo() - 1);
+                    if (baseActionIndex < 0) {
+                        calcSuccessorState(state, index, next);
+                        base.setTo(next);
+                        baseActionIndex = index;
+                    } else {
+                        calcSuccessorState(state, index, base, baseActionIndex,
+                                           next);
+                    }
 
                     // Now that we have the successor state, we can (again) use
                     // any action to calculate the reward of the next state.
@@ -104,11 +133,22 @@ void MinimalLookaheadSearch::estimateQValues(State const& state,
             // while the positive effect of the action is not. Since noop is
             // always applicable in this task, we apply in the next state to
             // account for those positive effects.
+            State base;
+            State next;
+            int baseActionIndex = -1;
             for (size_t index = 0; index < actionsToExpand.size(); ++index) {
                 if (actionsToExpand[index] == index) {
-                    State next;
+                    next.reset(state.stepsToGo() - 1);
+                    if (baseActionIndex < 0) {
+                        calcSuccessorState(state, index, next);
+                        base.setTo(next);
+                        baseActionIndex = index;
+                    } else {
+                        calcSuccessorState(state, index, base, baseActionIndex,
+                                           next);
+                    }
                     double reward;
-                    calcStateTransition(state, index, next, reward);
+                    calcReward(state, index, reward);
 
                     // Use noop to calculate the reward in the next state.
                     double reward2;
@@ -126,7 +166,9 @@ void MinimalLookaheadSearch::estimateQValues(State const& state,
         }
 
         if (cachingEnabled) {
-            rewardCache[state] = qValues;
+            CacheLock lock(rewardCacheMutex);
+            copy(qValues.begin(), qValues.end(),
+                 rewardCacheTable.begin() + getRewardCacheRow(state));
         }
 
         for (size_t index = 0; index < qValues.size(); ++index) {
@@ -139,6 +181,18 @@ void MinimalLookaheadSearch::estimateQValues(State const& state,
     }
 }
 
+size_t MinimalLookaheadSearch::getRewardCacheRow(State const& state) const {
+    HashMap::const_iterator it = rewardCache.find(state);
+    if (it != rewardCache.end()) {
+        return it->second;
+    }
+    size_t row = rewardCacheTable.size();
+    rewardCacheTable.resize(row + SearchEngine::numberOfActions,
+                            -std::numeric_limits<double>::max());
+    rewardCache[state] = row;
+    return row;
+}
+
 void MinimalLookaheadSearch::printRoundStatistics(std::string indent) const {
     Logger::logLine(indent + name + " round statistics:", Verbosity::NORMAL);
     indent += "  ";
@@ -41,14 +41,22 @@ public:
     void printRoundStatistics(std::string indent) const override;
     void printStepStatistics(std::string indent) const override;
 
-    // Caching
-    typedef std::unordered_map<State, std::vector<double>,
-                               State::HashWithoutRemSteps,
+    // Caching: rewardCache maps each cached state to the position of its
+    // first Q-value in rewardCacheTable, where the Q-values of all actions
+    // are stored consecutively
+    typedef std::unordered_map<State, size_t, State::HashWithoutRemSteps,
                                State::EqualWithoutRemSteps>
         HashMap;
     static HashMap rewardCache;
+    static std::vector<double> rewardCacheTable;
+    static std::mutex rewardCacheMutex;
 
 protected:
+    // Returns the position of the first Q-value of state in rewardCacheTable,
+    // and adds a row where all Q-values are undefined if state is not cached
+    // yet (rewardCacheMutex must be locked)
+    size_t getRewardCacheRow(State const& state) const;
+
     void printRewardCacheUsage(
             std::string indent, Verbosity verbosity = Verbosity::VERBOSE) const;
 
@@ -58,6 +58,10 @@ OutcomeSelection* OutcomeSelection::fromString(std::string& desc, THTS* thts) {
 SearchNode* MCOutcomeSelection::selectOutcome(SearchNode* node,
                                               PDState& nextState, int varIndex,
                                               int lastProbVarIndex) {
+    // No new nodes are created if the memory budget of the tree is exhausted
+    if (node->children.empty() && thts->treeMemoryExhausted()) {
+        return nullptr;
+    }
     if (node->children.empty()) {
         node->children.resize(
             SearchEngine::probabilisticCPFs[varIndex]->getDomainSize(),
@@ -69,7 +73,9 @@ SearchNode* MCOutcomeSelection::selectOutcome(SearchNode* node,
     int childIndex = static_cast<int>(sample.first);
     assert((childIndex >= 0) && childIndex < node->children.size());
 
-    if (!node->children[childIndex]) {
+    if (!node->children[childIndex] && thts->treeMemoryExhausted()) {
+        return nullptr;
+    } else if (!node->children[childIndex]) {
         if (varIndex == lastProbVarIndex) {
             node->children[childIndex] =
                 thts->createDecisionNode(sample.second);
@@ -29,7 +29,8 @@ public:
     virtual void finishStep() {}
     virtual void initTrial() {}
 
-    // Outcome selection
+    // Outcome selection (returns nullptr if the selected outcome would
+    // require a new node but the memory budget of the tree is exhausted)
     virtual SearchNode* selectOutcome(SearchNode* node, PDState& nextState,
                                       int varIndex, int lastProbVarIndex) = 0;
 
@@ -15,6 +15,7 @@ void Parser::parseTask(map<string, int>& stateVariableIndices,
         SystemUtils::abort("Error: Unable to read problem file: " +
                            problemFileName);
     }
+    SearchEngine::taskHash = hash<string>()(problemDesc);
     stringstream desc(problemDesc);
     // Parse general task properties
     desc >> SearchEngine::taskName;
@@ -160,6 +161,8 @@ void Parser::parseTask(map<string, int>& stateVariableIndices,
     for (size_t i = 0; i < SearchEngine::numberOfActions; ++i) {
         parseActionState(desc);
     }
+    SearchEngine::initPreconditionGroups();
+    SearchEngine::initOptimalFinalRewardTable();
 
     // Parse hash keys
     if (State::stateHashingPossible) {
@@ -408,6 +411,18 @@ void Parser::parseCachingType(stringstream& desc,
                 desc >> detEval->evaluationCacheVector[i];
             }
         }
+    } else if (cachingType == "LAZY_VECTOR") {
+        long cachingVecSize;
+        desc >> cachingVecSize;
+
+        detEval->cachingType = Evaluatable::LAZY_VECTOR;
+        detEval->evaluationCacheVector.resize(cachingVecSize,
+                                              -numeric_limits<double>::max());
+
+        if (probEval) {
+            probEval->cachingType = Evaluatable::LAZY_VECTOR;
+            probEval->evaluationCacheVector.resize(cachingVecSize);
+        }
     } else {
         assert(cachingType == "MAP");
         detEval->cachingType = Evaluatable::MAP;
@@ -32,6 +32,88 @@ bool DiscretePD::isWellDefined() const {
     return MathUtils::doubleIsEqual(probSum, 1.0);
 }
 
+void DiscretePD::sortOutcomes() {
+    assert(values.size() == probabilities.size());
+    size_t numOutcomes = values.size();
+    if (numOutcomes < 2) {
+        return;
+    }
+
+    // Outcomes of, e.g., a subtraction are often sorted in descending order
+    bool isDescending = true;
+    for (size_t i = 1; i < numOutcomes; ++i) {
+        if (values[i - 1] < values[i]) {
+            isDescending = false;
+            break;
+        }
+    }
+    if (isDescending) {
+        reverse(values.begin(), values.end());
+        reverse(probabilities.begin(), probabilities.end());
+    } else {
+        // Insertion sort (the number of outcomes is typically small)
+        for (size_t i = 1; i < numOutcomes; ++i) {
+            double val = values[i];
+            double prob = probabilities[i];
+            size_t j = i;
+            for (; (j > 0) && (val < values[j - 1]); --j) {
+                values[j] = values[j - 1];
+                probabilities[j] = probabilities[j - 1];
+            }
+            values[j] = val;
+            probabilities[j] = prob;
+        }
+    }
+
+    // Merge outcomes with identical values
+    size_t last = 0;
+    for (size_t i = 1; i < numOutcomes; ++i) {
+        if (values[i] == values[last]) {
+            probabilities[last] += probabilities[i];
+        } else {
+            ++last;
+            values[last] = values[i];
+            probabilities[last] = probabilities[i];
+        }
+    }
+    values.resize(last + 1);
+    probabilities.resize(last + 1);
+}
+
+void DiscretePD::mergeOutcomes(DiscretePD const& other, DiscretePD& buffer) {
+    assert(this != &other && this != &buffer && &other != &buffer);
+    buffer.reset();
+    size_t i = 0;
+    size_t j = 0;
+    while ((i < values.size()) && (j < other.values.size())) {
+        if (values[i] < other.values[j]) {
+            buffer.values.push_back(values[i]);
+            buffer.probabilities.push_back(probabilities[i]);
+            ++i;
+        } else if (other.values[j] < values[i]) {
+            buffer.values.push_back(other.values[j]);
+            buffer.probabilities.push_back(other.probabilities[j]);
+            ++j;
+        } else {
+            buffer.values.push_back(values[i]);
+            buffer.probabilities.push_back(probabilities[i] +
+                                           other.probabilities[j]);
+            ++i;
+            ++j;
+        }
+    }
+    for (; i < values.size(); ++i) {
+        buffer.values.push_back(values[i]);
+        buffer.probabilities.push_back(probabilities[i]);
+    }
+    for (; j < other.values.size(); ++j) {
+        buffer.values.push_back(other.values[j]);
+        buffer.probabilities.push_back(other.probabilities[j]);
+    }
+    values.swap(buffer.values);
+    probabilities.swap(buffer.probabilities);
+}
+
 string DiscretePD::toString() const {
     stringstream ss;
     ss << "[ ";
@@ -91,6 +91,21 @@ public:
         probabilities.clear();
     }
 
+    // The following two functions allow to build distributions without the
+    // map that is used in assignDiscrete. As they only move outcomes within
+    // the given vectors, they do not allocate memory if the capacity of the
+    // vectors is sufficient.
+
+    // Sorts the outcomes by value and merges outcomes with identical values
+    // (their probabilities are summed up). This is linear if the outcomes are
+    // sorted in ascending or descending order already.
+    void sortOutcomes();
+
+    // Adds the outcomes of other to this, where both must be sorted. Outcomes
+    // with identical values are merged. buffer is used to store the result
+    // temporarily and contains the previous outcomes of this afterwards.
+    void mergeOutcomes(DiscretePD const& other, DiscretePD& buffer);
+
     double probabilityOf(double const& val) const {
         for (unsigned int i = 0; i < values.size(); ++i) {
             if (MathUtils::doubleIsEqual(values[i], val)) {
@@ -1,5 +1,6 @@
 #include "prost_planner.h"
 
+#include "cache_snapshot.h"
 #include "iterative_deepening_search.h"
 #include "minimal_lookahead_search.h"
 #include "search_engine.h"
@@ -10,6 +11,7 @@
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace std;
@@ -23,9 +25,14 @@ ProstPlanner::ProstPlanner(string& plannerDesc)
       executedActionIndex(-1),
       numberOfRounds(-1),
       cachingEnabled(true),
+      timeForThisStep(0.0),
+      timeBank(0.0),
+      savedTimeInRound(0.0),
+      reallocatedTimeInRound(0.0),
       ramLimit(2097152),
       bitSize(sizeof(long) * 8),
-      tmMethod(NONE) {
+      tmMethod(NONE),
+      maxNumberOfRewardLockTransitions(1048576) {
     setSeed((int)time(nullptr));
 
     StringUtils::trim(plannerDesc);
@@ -52,12 +59,18 @@ ProstPlanner::ProstPlanner(string& plannerDesc)
         } else if (param == "-tm") {
             if (value == "UNI") {
                 setTimeoutManagementMethod(UNIFORM);
+            } else if (value == "ADA") {
+                setTimeoutManagementMethod(ADAPTIVE);
             } else if (value == "NONE") {
                 setTimeoutManagementMethod(NONE);
             } else {
                 SystemUtils::abort("Illegal timeout management method: " +
                                    value);
             }
+        } else if (param == "-cache") {
+            setCacheSnapshotFile(value);
+        } else if (param == "-rls") {
+            setMaxNumberOfRewardLockTransitions(atol(value.c_str()));
         } else if (param == "-se") {
             setSearchEngine(SearchEngine::fromString(value));
             searchEngineDefined = true;
@@ -98,12 +111,18 @@ void ProstPlanner::initSession(int _numberOfRounds, long /*totalTime*/) {
 
     currentRound = -1;
     numberOfRounds = _numberOfRounds;
-    if (tmMethod == UNIFORM) {
+    if ((tmMethod == UNIFORM) || (tmMethod == ADAPTIVE)) {
         remainingTimeFactor = numberOfRounds * SearchEngine::horizon;
     }
 
     cout.precision(6);
 
+    // Warm-start the caches before the search engine is initialized, as some
+    // search engines already perform search (e.g., to learn parameters)
+    if (!cacheSnapshotFile.empty()) {
+        CacheSnapshot::load(cacheSnapshotFile);
+    }
+
     searchEngine->initSession();
 
     if (searchEngine->usesBDDs()) {
@@ -116,6 +135,11 @@ void ProstPlanner::initSession(int _numberOfRounds, long /*totalTime*/) {
             domains[index] = SearchEngine::allCPFs[index]->getDomainSize();
         }
         fdd_extdomain(domains, KleeneState::stateSize);
+
+        if (maxNumberOfRewardLockTransitions > 0) {
+            ProbabilisticSearchEngine::computeRewardLockRegions(
+                maxNumberOfRewardLockTransitions);
+        }
     }
 
     printConfig();
@@ -130,6 +154,10 @@ void ProstPlanner::finishSession(double& totalReward) {
     double avgReward = totalReward / numberOfRounds;
     Logger::logLine(">>> END OF SESSION  -- AVERAGE REWARD: " +
                     to_string(avgReward), Verbosity::SILENT);
+
+    if (!cacheSnapshotFile.empty()) {
+        CacheSnapshot::save(cacheSnapshotFile);
+    }
 }
 
 void ProstPlanner::initRound(long const& remainingTime) {
@@ -137,6 +165,12 @@ void ProstPlanner::initRound(long const& remainingTime) {
     currentStep = -1;
     stepsToGo = SearchEngine::horizon + 1;
 
+    // Time that has not been reallocated in the last round is part of the
+    // remaining time that is distributed uniformly
+    timeBank = 0.0;
+    savedTimeInRound = 0.0;
+    reallocatedTimeInRound = 0.0;
+
     Logger::logSeparator(Verbosity::NORMAL);
     Logger::logLine(">>> STARTING ROUND " + to_string(currentRound + 1) +
                     " -- REMAINING TIME " + to_string(remainingTime / 1000) +
@@ -154,6 +188,13 @@ void ProstPlanner::finishRound(double const& roundReward) {
                     " -- REWARD RECEIVED: " + to_string(roundReward),
                     Verbosity::SILENT);
     Logger::logSmallSeparator(Verbosity::NORMAL);
+    if (tmMethod == ADAPTIVE) {
+        Logger::logLine("Saved time: " + to_string(savedTimeInRound) + "s",
+                        Verbosity::NORMAL);
+        Logger::logLine("Reallocated time: " +
+                        to_string(reallocatedTimeInRound) + "s",
+                        Verbosity::NORMAL);
+    }
     searchEngine->printRoundStatistics("");
     Logger::logLine("", Verbosity::NORMAL);
 
@@ -208,16 +249,31 @@ void ProstPlanner::finishStep(double const& immediateReward) {
         Verbosity::SILENT);
     Logger::logLine("Immediate reward: " + to_string(immediateReward),
                     Verbosity::NORMAL);
+    if (tmMethod == ADAPTIVE) {
+        Logger::logLine("Time bank: " + to_string(timeBank) + "s",
+                        Verbosity::NORMAL);
+    }
 
     // Notify search engine
+    searchEngine->setExecutedAction(executedActionIndex);
     searchEngine->finishStep();
 }
 
 vector<string> ProstPlanner::plan() {
     // Call the search engine
     vector<int> bestActions;
+    stepStopwatch.reset();
     searchEngine->estimateBestActions(currentState, bestActions);
 
+    // Bank the time that has not been used in this step
+    if (tmMethod == ADAPTIVE) {
+        double savedTime = timeForThisStep - stepStopwatch();
+        if (MathUtils::doubleIsGreater(savedTime, 0.0)) {
+            timeBank += savedTime;
+            savedTimeInRound += savedTime;
+        }
+    }
+
     // Pick one of the recommended actions uniformly at random
     executedActionIndex = MathUtils::rnd->randomElement(bestActions);
     ActionState const& executedAction =
@@ -261,7 +317,7 @@ void ProstPlanner::manageTimeouts(long const& remainingTime) {
         // We use a buffer of 3 seconds
         remainingTimeInSeconds -= 3.0;
     }
-    double timeForThisStep = 0.0;
+    timeForThisStep = 0.0;
 
     switch (tmMethod) {
     case NONE:
@@ -271,6 +327,19 @@ void ProstPlanner::manageTimeouts(long const& remainingTime) {
         timeForThisStep = remainingTimeInSeconds / remainingTimeFactor;
         --remainingTimeFactor;
         break;
+    case ADAPTIVE: {
+        // Each step gets its uniform share of the time that is not banked,
+        // and the banked time is distributed among the remaining steps of the
+        // round (steps that need less time return it to the bank)
+        double unbankedTime = max(remainingTimeInSeconds - timeBank, 0.0);
+        double reallocatedTime = timeBank / stepsToGo;
+        timeForThisStep =
+            (unbankedTime / remainingTimeFactor) + reallocatedTime;
+        timeBank -= reallocatedTime;
+        reallocatedTimeInRound += reallocatedTime;
+        --remainingTimeFactor;
+        break;
+    }
     }
     Logger::logLine("Setting time for this decision to " +
                     to_string(timeForThisStep) + "s.", Verbosity::NORMAL);
@@ -287,11 +356,25 @@ void ProstPlanner::printConfig() const {
         "  RAM limit: " + std::to_string(ramLimit), Verbosity::VERBOSE);
     Logger::logLine(
         "  Bit size: " + std::to_string(bitSize), Verbosity::VERBOSE);
+    if (cacheSnapshotFile.empty()) {
+        Logger::logLine("  Cache snapshot: disabled", Verbosity::VERBOSE);
+    } else {
+        Logger::logLine(
+            "  Cache snapshot: " + cacheSnapshotFile, Verbosity::VERBOSE);
+    }
+
+    Logger::logLine("  Maximal number of transitions for reward lock "
+                    "precomputation: " +
+                        std::to_string(maxNumberOfRewardLockTransitions),
+                    Verbosity::VERBOSE);
 
     switch(tmMethod) {
         case UNIFORM:
             Logger::logLine("  Timeout method: UNIFORM", Verbosity::VERBOSE);
             break;
+        case ADAPTIVE:
+            Logger::logLine("  Timeout method: ADAPTIVE", Verbosity::VERBOSE);
+            break;
         case NONE:
             Logger::logLine("  Timeout method: NONE", Verbosity::VERBOSE);
             break;
@@ -327,6 +410,9 @@ void ProstPlanner::resetStaticMembers() {
     SearchEngine::deterministicCPFs.clear();
     SearchEngine::actionPreconditions.clear();
     SearchEngine::actionStates.clear();
+    SearchEngine::preconditionGroups.clear();
+    SearchEngine::optimalFinalRewardTable.clear();
+    SearchEngine::optimalFinalActionTable.clear();
     SearchEngine::trainingSet.clear();
     SearchEngine::actionPreconditions.clear();
     State::stateFluentHashKeysOfDeterministicStateFluents.clear();
@@ -335,5 +421,7 @@ void ProstPlanner::resetStaticMembers() {
     State::stateHashKeysOfProbabilisticStateFluents.clear();
     KleeneState::hashKeyBases.clear();
     KleeneState::indexToStateFluentHashKeyMap.clear();
+    SearchEngine::rewardLockRegionsComputed = false;
+    LogicalExpression::resetSharedSubformulas();
     MathUtils::resetRNG();
 }
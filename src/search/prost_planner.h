@@ -4,13 +4,15 @@
 #include "search_engine.h"
 #include "states.h"
 
+#include "utils/stopwatch.h"
+
 #include <cassert>
 
 class PlanningTask;
 
 class ProstPlanner {
 public:
-    enum TimeoutManagementMethod { NONE, UNIFORM };
+    enum TimeoutManagementMethod { NONE, UNIFORM, ADAPTIVE };
 
     ProstPlanner(std::string& plannerDesc);
 
@@ -53,6 +55,15 @@ public:
     void setTimeoutManagementMethod(TimeoutManagementMethod _tmMethod) {
         tmMethod = _tmMethod;
     }
+
+    void setCacheSnapshotFile(std::string _cacheSnapshotFile) {
+        cacheSnapshotFile = _cacheSnapshotFile;
+    }
+
+    void setMaxNumberOfRewardLockTransitions(
+        long _maxNumberOfRewardLockTransitions) {
+        maxNumberOfRewardLockTransitions = _maxNumberOfRewardLockTransitions;
+    }
     
     // Resets the static objects used within all components. Has to be called if
     // the planner is used multiple times within one run, or for unit tests
@@ -81,11 +92,22 @@ private:
 
     int remainingTimeFactor;
 
+    // The adaptive timeout management banks the time that is not used in a
+    // step (e.g., since the search engine terminates early) and distributes it
+    // among the remaining steps of the round
+    Stopwatch stepStopwatch;
+    double timeForThisStep;
+    double timeBank;
+    double savedTimeInRound;
+    double reallocatedTimeInRound;
+
     // Parameter
     int ramLimit;
     int bitSize;
     int seed;
     TimeoutManagementMethod tmMethod;
+    std::string cacheSnapshotFile;
+    long maxNumberOfRewardLockTransitions;
 };
 
 #endif
@@ -37,23 +37,25 @@ void RandomWalk::estimateQValues(State const& state,
 }
 
 void RandomWalk::performRandomWalks(PDState const& root, int firstActionIndex,
-                                    double& result) const {
+                                    double& result) {
     result = 0.0;
     double reward = 0.0;
-    PDState next;
 
     for (unsigned int i = 0; i < numberOfIterations; ++i) {
-        PDState current(root.stepsToGo() - 1);
-        sampleSuccessorState(root, firstActionIndex, current, reward);
+        PDState* current = &walkStates[0];
+        PDState* next = &walkStates[1];
+        current->reset(root.stepsToGo() - 1);
+        sampleSuccessorState(root, firstActionIndex, *current, reward);
         result += reward;
 
-        while (current.stepsToGo() > 0) {
-            int rndActionIndex = MathUtils::rnd->randomElement(
-                getIndicesOfApplicableActions(current));
-            next.reset(current.stepsToGo() - 1);
-            sampleSuccessorState(current, rndActionIndex, next, reward);
+        while (current->stepsToGo() > 0) {
+            calcIndicesOfApplicableActions(*current);
+            int rndActionIndex =
+                MathUtils::rnd->randomElement(applicableActionIndices);
+            next->reset(current->stepsToGo() - 1);
+            sampleSuccessorState(*current, rndActionIndex, *next, reward);
             result += reward;
-            current = next;
+            std::swap(current, next);
         }
     }
     result /= (double)numberOfIterations;
@@ -72,6 +74,16 @@ void RandomWalk::sampleSuccessorState(PDState const& current,
     State::calcStateHashKey(next);
 }
 
+void RandomWalk::calcIndicesOfApplicableActions(State const& state) {
+    std::vector<int> applicableActions = getApplicableActions(state);
+    applicableActionIndices.clear();
+    for (size_t index = 0; index < applicableActions.size(); ++index) {
+        if (applicableActions[index] == index) {
+            applicableActionIndices.push_back(index);
+        }
+    }
+}
+
 void RandomWalk::printConfig(std::string indent) const {
     SearchEngine::printConfig(indent);
     indent += "  ";
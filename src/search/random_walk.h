@@ -4,7 +4,10 @@
 #include "search_engine.h"
 
 // Evaluates all actions by simulating a run that starts with that action
-// followed by random actions until a terminal state is reached
+// followed by random actions until a terminal state is reached. The states of
+// a walk alternate between two buffers, and the indices of the actions that
+// are sampled from are written to a buffer as well, such that all walks reuse
+// the same memory.
 
 class RandomWalk : public ProbabilisticSearchEngine {
 public:
@@ -39,12 +42,23 @@ public:
 
 private:
     void performRandomWalks(PDState const& root, int firstActionIndex,
-                            double& result) const;
+                            double& result);
     void sampleSuccessorState(PDState const& current, int const& actionIndex,
                               PDState& next, double& reward) const;
 
+    // Writes the indices of the applicable and reasonable actions in state to
+    // applicableActionIndices (the actions are taken from the shared cache of
+    // applicable actions)
+    void calcIndicesOfApplicableActions(State const& state);
+
     // Parameter
     int numberOfIterations;
+
+    // The buffers for the states of a walk
+    PDState walkStates[2];
+
+    // The buffer for the indices of applicable and reasonable actions
+    std::vector<int> applicableActionIndices;
 };
 
 #endif
@@ -5,6 +5,7 @@
 #include "depth_first_search.h"
 #include "exhaustive_mdp.h"
 #include "iterative_deepening_search.h"
+#include "lrtdp.h"
 #include "minimal_lookahead_search.h"
 #include "random_walk.h"
 #include "thts.h"
@@ -14,6 +15,8 @@
 #include "utils/string_utils.h"
 #include "utils/system_utils.h"
 
+#include <algorithm>
+
 using namespace std;
 
 /******************************************************************
@@ -41,6 +44,7 @@ vector<long> KleeneState::hashKeyBases;
 vector<vector<pair<int, long>>> KleeneState::indexToStateFluentHashKeyMap;
 
 string SearchEngine::taskName;
+size_t SearchEngine::taskHash = 0;
 vector<State> SearchEngine::trainingSet;
 
 vector<ActionState> SearchEngine::actionStates;
@@ -56,6 +60,7 @@ vector<DeterministicCPF*> SearchEngine::determinizedCPFs;
 
 RewardFunction* SearchEngine::rewardCPF = nullptr;
 vector<DeterministicEvaluatable*> SearchEngine::actionPreconditions;
+vector<SearchEngine::PreconditionGroup> SearchEngine::preconditionGroups;
 
 bool SearchEngine::taskIsDeterministic = true;
 State SearchEngine::initialState;
@@ -63,12 +68,18 @@ int SearchEngine::horizon = numeric_limits<int>::max();
 double SearchEngine::discountFactor = 1.0;
 int SearchEngine::numberOfActions = -1;
 vector<int> SearchEngine::candidatesForOptimalFinalAction;
+vector<double> SearchEngine::optimalFinalRewardTable;
+vector<int> SearchEngine::optimalFinalActionTable;
+long SearchEngine::finalRewardTableStride = 1;
+std::mutex SearchEngine::finalRewardTableMutex;
 
 bool SearchEngine::cacheApplicableActions = true;
 bool SearchEngine::rewardLockDetected = true;
 int SearchEngine::goalTestActionIndex = -1;
 bdd SearchEngine::cachedDeadEnds = bddfalse;
 bdd SearchEngine::cachedGoals = bddfalse;
+bool SearchEngine::rewardLockRegionsComputed = false;
+std::mutex SearchEngine::rewardLockMutex;
 
 bool ProbabilisticSearchEngine::hasUnreasonableActions = true;
 bool DeterministicSearchEngine::hasUnreasonableActions = true;
@@ -83,6 +94,9 @@ SearchEngine::StateValueHashMap ProbabilisticSearchEngine::stateValueCache(
 SearchEngine::StateValueHashMap DeterministicSearchEngine::stateValueCache(
     520241);
 
+std::mutex ProbabilisticSearchEngine::cacheMutex;
+std::mutex DeterministicSearchEngine::cacheMutex;
+
 /******************************************************************
                      Search Engine Creation
 ******************************************************************/
@@ -171,6 +185,9 @@ SearchEngine* SearchEngine::fromString(string& desc) {
     } else if (isConfig("RandomWalk")) {
         desc = desc.substr(10, desc.size());
         result = new RandomWalk();
+    } else if (isConfig("LRTDP")) {
+        desc = desc.substr(5, desc.size());
+        result = new LRTDP();
     } else if(isConfig("ExhaustiveMDP")) {
         desc = desc.substr(13, desc.size());
         result = new ExhaustiveMDPGenerator();
@@ -348,10 +365,17 @@ bool ProbabilisticSearchEngine::isARewardLock(State const& current) const {
 
     assert(goalTestActionIndex >= 0);
 
+    if (rewardLockRegionsComputed) {
+        CacheLock lock(rewardLockMutex);
+        return BDDIncludes(cachedDeadEnds, current) ||
+               BDDIncludes(cachedGoals, current);
+    }
+
     // Calculate the reference reward
     double reward = 0.0;
     calcReward(current, goalTestActionIndex, reward);
 
+    CacheLock lock(rewardLockMutex);
     if (MathUtils::doubleIsEqual(rewardCPF->getMinVal(), reward)) {
         // Check if current is known to be a dead end
         if (cacheRewardLocks && BDDIncludes(cachedDeadEnds, current)) {
@@ -467,8 +491,187 @@ bool ProbabilisticSearchEngine::checkGoal(KleeneState const& state) const {
     return false;
 }
 
+void ProbabilisticSearchEngine::computeRewardLockRegions(
+    long maxNumberOfTransitions) {
+    assert(goalTestActionIndex >= 0);
+
+    // The index of a state is the sum of its values multiplied with the
+    // multipliers of the variables
+    long numberOfStates = 1;
+    vector<long> multipliers(KleeneState::stateSize);
+    for (size_t i = 0; i < KleeneState::stateSize; ++i) {
+        multipliers[i] = numberOfStates;
+        numberOfStates *= allCPFs[i]->getDomainSize();
+        if (numberOfStates * numberOfActions > maxNumberOfTransitions) {
+            Logger::logLine("Reward locks are not precomputed as there are "
+                            "more than " + to_string(maxNumberOfTransitions) +
+                            " transitions", Verbosity::VERBOSE);
+            return;
+        }
+    }
+
+    // Each concrete state is a KleeneState where each set contains one value.
+    // The KleeneState successor of such a state is the set of all successors.
+    vector<RewardLockCandidate> deadEndCandidates;
+    vector<RewardLockCandidate> goalCandidates;
+    long numberOfSuccessors = 0;
+    vector<int> values(KleeneState::stateSize, 0);
+    for (long stateIndex = 0; stateIndex < numberOfStates; ++stateIndex) {
+        KleeneState state;
+        for (size_t i = 0; i < KleeneState::stateSize; ++i) {
+            state[i].insert(values[i]);
+        }
+        KleeneState::calcStateHashKey(state);
+        KleeneState::calcStateFluentHashKeys(state);
+
+        // A dead end candidate yields minimal reward under all actions
+        RewardLockCandidate deadEndCandidate;
+        bool isDeadEndCandidate = true;
+        for (size_t index = 0; index < numberOfActions; ++index) {
+            set<double> reward;
+            rewardCPF->evaluateToKleene(reward, state, actionStates[index]);
+            if ((reward.size() != 1) ||
+                !MathUtils::doubleIsEqual(*reward.begin(),
+                                          rewardCPF->getMinVal())) {
+                isDeadEndCandidate = false;
+                break;
+            }
+            KleeneState succ;
+            for (size_t i = 0; i < KleeneState::stateSize; ++i) {
+                allCPFs[i]->evaluateToKleene(succ[i], state,
+                                             actionStates[index]);
+            }
+            addStateIndices(succ, multipliers, deadEndCandidate.successors);
+        }
+        if (isDeadEndCandidate) {
+            vector<long>& succs = deadEndCandidate.successors;
+            sort(succs.begin(), succs.end());
+            succs.erase(unique(succs.begin(), succs.end()), succs.end());
+            numberOfSuccessors += succs.size();
+            deadEndCandidate.stateIndex = stateIndex;
+            deadEndCandidate.state = stateToBDD(state);
+            deadEndCandidates.push_back(std::move(deadEndCandidate));
+        }
+
+        // A goal candidate yields maximal reward under goalTestActionIndex
+        set<double> reward;
+        rewardCPF->evaluateToKleene(reward, state,
+                                    actionStates[goalTestActionIndex]);
+        if ((reward.size() == 1) &&
+            MathUtils::doubleIsEqual(*reward.begin(), rewardCPF->getMaxVal())) {
+            KleeneState succ;
+            for (size_t i = 0; i < KleeneState::stateSize; ++i) {
+                allCPFs[i]->evaluateToKleene(
+                    succ[i], state, actionStates[goalTestActionIndex]);
+            }
+            RewardLockCandidate goalCandidate;
+            addStateIndices(succ, multipliers, goalCandidate.successors);
+            numberOfSuccessors += goalCandidate.successors.size();
+            goalCandidate.stateIndex = stateIndex;
+            goalCandidate.state = stateToBDD(state);
+            goalCandidates.push_back(std::move(goalCandidate));
+        }
+
+        // The successors of the candidates are bounded like the transitions
+        if (numberOfSuccessors > maxNumberOfTransitions) {
+            Logger::logLine("Reward locks are not precomputed as the "
+                            "candidates have more than " +
+                                to_string(maxNumberOfTransitions) +
+                                " successors",
+                            Verbosity::VERBOSE);
+            return;
+        }
+
+        // Move on to the next state
+        for (size_t i = 0; i < KleeneState::stateSize; ++i) {
+            if (++values[i] < allCPFs[i]->getDomainSize()) {
+                break;
+            }
+            values[i] = 0;
+        }
+    }
+
+    long numberOfDeadEnds = 0;
+    long numberOfGoals = 0;
+    cachedDeadEnds = calcGreatestFixpoint(deadEndCandidates, numberOfStates,
+                                          numberOfDeadEnds);
+    cachedGoals =
+        calcGreatestFixpoint(goalCandidates, numberOfStates, numberOfGoals);
+    rewardLockRegionsComputed = true;
+
+    Logger::logLine("Precomputed reward locks: " +
+                        to_string(numberOfDeadEnds) + " dead ends and " +
+                        to_string(numberOfGoals) + " goals in " +
+                        to_string(numberOfStates) + " states",
+                    Verbosity::NORMAL);
+}
+
+void ProbabilisticSearchEngine::addStateIndices(
+    KleeneState const& state, vector<long> const& multipliers,
+    vector<long>& indices) {
+    vector<long> stateIndices(1, 0);
+    for (size_t i = 0; i < KleeneState::stateSize; ++i) {
+        vector<long> extendedIndices;
+        for (long index : stateIndices) {
+            for (double value : state[i]) {
+                extendedIndices.push_back(
+                    index + static_cast<long>(value) * multipliers[i]);
+            }
+        }
+        stateIndices.swap(extendedIndices);
+    }
+    indices.insert(indices.end(), stateIndices.begin(), stateIndices.end());
+}
+
+bdd ProbabilisticSearchEngine::calcGreatestFixpoint(
+    vector<RewardLockCandidate> const& candidates, long numberOfStates,
+    long& regionSize) {
+    vector<long> candidateOfState(numberOfStates, -1);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        candidateOfState[candidates[i].stateIndex] = i;
+    }
+
+    // A candidate with a successor that is no candidate is removed right
+    // away, and all others are predecessors of their successors
+    vector<bool> isRemoved(candidates.size(), false);
+    vector<long> removed;
+    vector<vector<long>> predecessors(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        for (long succ : candidates[i].successors) {
+            long succCandidate = candidateOfState[succ];
+            if (succCandidate < 0) {
+                isRemoved[i] = true;
+                removed.push_back(i);
+                break;
+            }
+            predecessors[succCandidate].push_back(i);
+        }
+    }
+
+    while (!removed.empty()) {
+        long candidate = removed.back();
+        removed.pop_back();
+        for (long pred : predecessors[candidate]) {
+            if (!isRemoved[pred]) {
+                isRemoved[pred] = true;
+                removed.push_back(pred);
+            }
+        }
+    }
+
+    bdd region = bddfalse;
+    regionSize = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (!isRemoved[i]) {
+            region |= candidates[i].state;
+            ++regionSize;
+        }
+    }
+    return region;
+}
+
 inline bdd ProbabilisticSearchEngine::stateToBDD(
-    KleeneState const& state) const {
+    KleeneState const& state) {
     bdd res = bddtrue;
     for (size_t i = 0; i < KleeneState::stateSize; ++i) {
         bdd tmp = bddfalse;
@@ -481,7 +684,7 @@ inline bdd ProbabilisticSearchEngine::stateToBDD(
     return res;
 }
 
-inline bdd ProbabilisticSearchEngine::stateToBDD(State const& state) const {
+inline bdd ProbabilisticSearchEngine::stateToBDD(State const& state) {
     bdd res = bddtrue;
     for (size_t i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
         res &= fdd_ithvar(i, state.deterministicStateFluent(i));
@@ -494,7 +697,12 @@ inline bdd ProbabilisticSearchEngine::stateToBDD(State const& state) const {
 }
 
 inline bool ProbabilisticSearchEngine::BDDIncludes(
-    bdd BDD, KleeneState const& state) const {
+    bdd BDD, KleeneState const& state) {
+    return (BDD & stateToBDD(state)) != bddfalse;
+}
+
+inline bool ProbabilisticSearchEngine::BDDIncludes(bdd BDD,
+                                                   State const& state) {
     return (BDD & stateToBDD(state)) != bddfalse;
 }
 
@@ -510,6 +718,11 @@ void SearchEngine::calcOptimalFinalReward(
         return calcReward(current, candidatesForOptimalFinalAction[0], reward);
     }
 
+    if (!optimalFinalActionTable.empty()) {
+        lookUpOptimalFinalAction(current, reward);
+        return;
+    }
+
     vector<int> applicableActions = getApplicableActions(current);
     if (candidatesForOptimalFinalAction.empty()) {
         // The first applicable action is guaranteed to be optimal
@@ -540,6 +753,11 @@ int SearchEngine::getOptimalFinalActionIndex(State const& current) const {
         return candidatesForOptimalFinalAction[0];
     }
 
+    if (!optimalFinalActionTable.empty()) {
+        double reward = 0.0;
+        return lookUpOptimalFinalAction(current, reward);
+    }
+
     vector<int> applicableActions = getApplicableActions(current);
     if (candidatesForOptimalFinalAction.empty()) {
         // The first applicable action is guaranteed to be optimal
@@ -566,6 +784,109 @@ int SearchEngine::getOptimalFinalActionIndex(State const& current) const {
     return result;
 }
 
+int SearchEngine::lookUpOptimalFinalAction(State const& current,
+                                           double& reward) const {
+    long key = current.stateFluentHashKey(rewardCPF->hashIndex) /
+               finalRewardTableStride;
+    assert((key >= 0) && (key < optimalFinalActionTable.size()));
+    {
+        CacheLock lock(finalRewardTableMutex);
+        if (optimalFinalActionTable[key] >= 0) {
+            reward = optimalFinalRewardTable[key];
+            return optimalFinalActionTable[key];
+        }
+    }
+
+    // All candidates are applicable and reasonable
+    reward = -numeric_limits<double>::max();
+    double tmpReward = 0.0;
+    int result = -1;
+    for (int index : candidatesForOptimalFinalAction) {
+        calcReward(current, index, tmpReward);
+        if (tmpReward > reward) {
+            reward = tmpReward;
+            result = index;
+        }
+    }
+
+    CacheLock lock(finalRewardTableMutex);
+    optimalFinalRewardTable[key] = reward;
+    optimalFinalActionTable[key] = result;
+    return result;
+}
+
+void SearchEngine::initOptimalFinalRewardTable() {
+    optimalFinalRewardTable.clear();
+    optimalFinalActionTable.clear();
+    finalRewardTableStride = 1;
+
+    // With a single candidate, the final reward is a single evaluation anyway
+    if ((candidatesForOptimalFinalAction.size() <= 1) ||
+        ((rewardCPF->cachingType != Evaluatable::VECTOR) &&
+         (rewardCPF->cachingType != Evaluatable::LAZY_VECTOR))) {
+        return;
+    }
+    for (int index : candidatesForOptimalFinalAction) {
+        if (!actionStates[index].actionPreconditions.empty()) {
+            return;
+        }
+    }
+
+    // An unreasonable candidate must not be considered, but whether an action
+    // is reasonable depends on the state
+    if (ProbabilisticSearchEngine::hasUnreasonableActions ||
+        DeterministicSearchEngine::hasUnreasonableActions) {
+        return;
+    }
+
+    // The state fluent hash keys of the reward are multiples of the number of
+    // its action hash keys
+    finalRewardTableStride = *max_element(rewardCPF->actionHashKeyMap.begin(),
+                                          rewardCPF->actionHashKeyMap.end()) +
+                             1;
+    long tableSize =
+        rewardCPF->evaluationCacheVector.size() / finalRewardTableStride;
+    optimalFinalRewardTable.assign(tableSize,
+                                   -numeric_limits<double>::max());
+    optimalFinalActionTable.assign(tableSize, -1);
+}
+
+void SearchEngine::initPreconditionGroups() {
+    preconditionGroups.clear();
+
+    // Actions with the same action hash key of a precondition are equivalent
+    // for it, so there is one group for each precondition and action hash key
+    map<pair<DeterministicEvaluatable*, long>, int> groupIndices;
+    vector<vector<int>> groupActions;
+    for (ActionState const& action : actionStates) {
+        for (DeterministicEvaluatable* precond : action.actionPreconditions) {
+            pair<DeterministicEvaluatable*, long> key(
+                precond, precond->actionHashKeyMap[action.index]);
+            auto it = groupIndices.find(key);
+            if (it == groupIndices.end()) {
+                it = groupIndices.emplace(key, preconditionGroups.size()).first;
+                PreconditionGroup group;
+                group.precond = precond;
+                group.actionIndex = action.index;
+                preconditionGroups.push_back(group);
+                groupActions.push_back(vector<int>());
+            }
+            groupActions[it->second].push_back(action.index);
+        }
+    }
+
+    for (size_t i = 0; i < preconditionGroups.size(); ++i) {
+        PreconditionGroup& group = preconditionGroups[i];
+        group.firstWord = groupActions[i].front() / 64;
+        int lastWord = groupActions[i].back() / 64;
+        group.actionMask.assign(lastWord - group.firstWord + 1, 0);
+        for (int actionIndex : groupActions[i]) {
+            group.actionMask[actionIndex / 64 - group.firstWord] |=
+                uint64_t(1) << (actionIndex % 64);
+        }
+    }
+}
+
 void SearchEngine::stateWithoutApplicableActionsDetected(
     State const& state) const {
     cout << endl;
@@ -833,6 +1154,9 @@ void SearchEngine::printEvaluatableInDetail(Evaluatable* eval) {
     case Evaluatable::VECTOR:
         Logger::log(" caching in vectors,");
         break;
+    case Evaluatable::LAZY_VECTOR:
+        Logger::log(" caching in lazily filled vectors,");
+        break;
     }
 
     switch (eval->kleeneCachingType) {
@@ -844,6 +1168,7 @@ void SearchEngine::printEvaluatableInDetail(Evaluatable* eval) {
         Logger::log(" Kleene caching in maps.");
         break;
     case Evaluatable::VECTOR:
+    case Evaluatable::LAZY_VECTOR:
         Logger::log(" Kleene caching in vectors of size " +
                     to_string(eval->kleeneEvaluationCacheVector.size()) + ".");
         break;
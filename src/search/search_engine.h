@@ -15,6 +15,7 @@
 
 #include "utils/logger.h"
 
+#include <cstdint>
 #include <fdd.h>
 
 class SearchEngine {
@@ -78,6 +79,11 @@ public:
     // Notify the search engine that the session starts
     virtual void initSession() {}
 
+    // Takes over what other, a search engine of the same type and
+    // configuration, has learned in its initSession, such that initSession
+    // of this search engine does not learn again
+    virtual void adoptLearnedParameters(SearchEngine const* /*other*/) {}
+
     // Notify the search engine that a new round starts or ends
     virtual void initRound() {}
     virtual void finishRound() {}
@@ -86,6 +92,10 @@ public:
     virtual void initStep(State const& /*current*/) {}
     virtual void finishStep() {}
 
+    // Notify the search engine which action has been executed in the current
+    // step (this is called right before finishStep)
+    virtual void setExecutedAction(int /*actionIndex*/) {}
+
     // Start the search engine to calculate best actions
     virtual void estimateBestActions(State const& _rootState,
                                      std::vector<int>& bestActions);
@@ -142,21 +152,39 @@ protected:
     // Return the index of the optimal last action
     int getOptimalFinalActionIndex(State const& current) const;
 
+private:
+    // Returns the index of the optimal final action in current and sets
+    // reward to its reward, where both are taken from the tables of optimal
+    // final actions and rewards if they have been computed before
+    int lookUpOptimalFinalAction(State const& current, double& reward) const;
+
     /*****************************************************************
                  Calculation of applicable actions
     *****************************************************************/
 
 protected:
-    bool actionIsApplicable(ActionState const& action,
-                            State const& current) const {
+    // Sets the bit of each action that is applicable in current and clears
+    // all others. Each precondition is evaluated once per group of equivalent
+    // actions, and all actions of a group where it is violated are removed at
+    // once.
+    void calcApplicableActionMask(State const& current,
+                                  std::vector<uint64_t>& mask) const {
+        mask.assign((numberOfActions + 63) / 64, ~uint64_t(0));
         double res = 0.0;
-        for (DeterministicEvaluatable* precond : action.actionPreconditions) {
-            precond->evaluate(res, current, action);
+        for (PreconditionGroup const& group : preconditionGroups) {
+            group.precond->evaluate(res, current,
+                                    actionStates[group.actionIndex]);
             if (MathUtils::doubleIsEqual(res, 0.0)) {
-                return false;
+                for (size_t i = 0; i < group.actionMask.size(); ++i) {
+                    mask[group.firstWord + i] &= ~group.actionMask[i];
+                }
             }
         }
-        return true;
+    }
+
+    static bool actionIsInMask(std::vector<uint64_t> const& mask,
+                               int actionIndex) {
+        return (mask[actionIndex / 64] >> (actionIndex % 64)) & 1;
     }
 
     /*****************************************************************
@@ -191,6 +219,10 @@ public:
     // The name of this task (this is equivalent to the instance name)
     static std::string taskName;
 
+    // A hash of the parser output that is used to identify the task (e.g., to
+    // tag cache snapshots)
+    static size_t taskHash;
+
     // Random set of reachable states (these are used for learning)
     static std::vector<State> trainingSet;
 
@@ -215,6 +247,24 @@ public:
     // The action preconditions
     static std::vector<DeterministicEvaluatable*> actionPreconditions;
 
+    // A precondition and a group of actions that are equivalent for it, i.e.,
+    // where it evaluates to the same result in every state. The group is a
+    // bitmask over the actions that is stored from word firstWord on (where
+    // actions 64 * i to 64 * i + 63 are in word i), and the precondition is
+    // evaluated under the action with index actionIndex.
+    struct PreconditionGroup {
+        DeterministicEvaluatable* precond = nullptr;
+        int actionIndex = -1;
+        int firstWord = 0;
+        std::vector<uint64_t> actionMask;
+    };
+    // The groups of all preconditions and the actions they are relevant for
+    static std::vector<PreconditionGroup> preconditionGroups;
+
+    // Computes preconditionGroups (must be called once the action states are
+    // known)
+    static void initPreconditionGroups();
+
     // Is true if this planning task is deterministic
     static bool taskIsDeterministic;
 
@@ -238,6 +288,23 @@ public:
     // different methods to speed up this calculation.
     static std::vector<int> candidatesForOptimalFinalAction;
 
+    // If the reward is cached in a vector and all candidates for the optimal
+    // final action are always applicable, the optimal final action and reward
+    // only depend on the state fluents that influence the reward. They are
+    // then cached in these tables at the state fluent hash key of the reward
+    // divided by finalRewardTableStride (the number of action hash keys of
+    // the reward) once they have been computed. As all candidates are
+    // considered in the tables, they are not used if unreasonable actions
+    // (which are never chosen as final action otherwise) have been detected.
+    static std::vector<double> optimalFinalRewardTable;
+    static std::vector<int> optimalFinalActionTable;
+    static long finalRewardTableStride;
+    static std::mutex finalRewardTableMutex;
+
+    // Allocates the tables above if possible (must be called once the reward
+    // function and the action states are known)
+    static void initOptimalFinalRewardTable();
+
     // Is true if applicable actions should be cached
     static bool cacheApplicableActions;
 
@@ -250,6 +317,12 @@ public:
     // The BDDs where dead ends and goals are cached
     static bdd cachedDeadEnds;
     static bdd cachedGoals;
+    // Is true if the BDDs above contain all dead ends and goals that can be
+    // detected (see ProbabilisticSearchEngine::computeRewardLockRegions)
+    static bool rewardLockRegionsComputed;
+    // Protects the BDDs and the Kleene caches of the evaluatables, which are
+    // only used in reward lock detection
+    static std::mutex rewardLockMutex;
 
     typedef std::unordered_map<State, double, State::HashWithRemSteps,
                                State::EqualWithRemSteps>
@@ -314,6 +387,19 @@ public:
     // Cache for applicable reasonable actions
     static ActionHashMap applicableActionsCache;
 
+    // Protects stateValueCache and applicableActionsCache while several
+    // threads search in parallel
+    static std::mutex cacheMutex;
+
+    // Computes the regions of all dead ends and goals as greatest fixpoints:
+    // starting from all states with minimal (maximal) reward, states with a
+    // successor outside of the region are removed until nothing changes.
+    // Afterwards, isARewardLock only tests if a state is in one of the
+    // regions. As all states are enumerated under all actions, this is only
+    // done if there are at most maxNumberOfTransitions pairs of a state and
+    // an action (and at most as many successors of candidates).
+    static void computeRewardLockRegions(long maxNumberOfTransitions);
+
     /*****************************************************************
                  Calculation of applicable actions
     *****************************************************************/
@@ -326,31 +412,55 @@ public:
     std::vector<int> getApplicableActions(State const& state) const override {
         std::vector<int> res(numberOfActions, 0);
 
-        ActionHashMap::iterator it = applicableActionsCache.find(state);
-        if (it != applicableActionsCache.end()) {
-            assert(it->second.size() == res.size());
-            for (size_t i = 0; i < res.size(); ++i) {
-                res[i] = it->second[i];
+        bool isCached = false;
+        {
+            CacheLock lock(cacheMutex);
+            ActionHashMap::iterator it = applicableActionsCache.find(state);
+            if (it != applicableActionsCache.end()) {
+                assert(it->second.size() == res.size());
+                for (size_t i = 0; i < res.size(); ++i) {
+                    res[i] = it->second[i];
+                }
+                isCached = true;
             }
-        } else {
+        }
+
+        if (!isCached) {
+            std::vector<uint64_t> applicableActionMask;
+            calcApplicableActionMask(state, applicableActionMask);
             bool applicableActionExists = false;
             if (hasUnreasonableActions) {
                 std::map<PDState, int, PDState::PDStateCompare> childStates;
 
+                // The successor of the first applicable action is the base
+                // for the computation of all other successors
+                PDState const* base = nullptr;
+                int baseActionIndex = -1;
+
                 for (size_t index = 0; index < numberOfActions; ++index) {
-                    if (actionIsApplicable(actionStates[index], state)) {
+                    if (actionIsInMask(applicableActionMask, index)) {
                         applicableActionExists = true;
                         // This action is applicable
                         PDState nxt(state.stepsToGo() - 1);
-                        calcSuccessorState(state, index, nxt);
+                        if (base) {
+                            calcSuccessorState(state, index, *base,
+                                               baseActionIndex, nxt);
+                        } else {
+                            calcSuccessorState(state, index, nxt);
+                        }
 
-                        if (childStates.find(nxt) == childStates.end()) {
+                        auto it = childStates.find(nxt);
+                        if (it == childStates.end()) {
                             // This action is reasonable
-                            childStates[nxt] = index;
+                            it = childStates.emplace(nxt, index).first;
                             res[index] = index;
+                            if (!base) {
+                                base = &(it->first);
+                                baseActionIndex = index;
+                            }
                         } else {
                             // This action is not reasonable
-                            res[index] = childStates[nxt];
+                            res[index] = it->second;
                         }
                     } else {
                         // This action is not appicable
@@ -359,7 +469,7 @@ public:
                 }
             } else {
                 for (size_t index = 0; index < numberOfActions; ++index) {
-                    if (actionIsApplicable(actionStates[index], state)) {
+                    if (actionIsInMask(applicableActionMask, index)) {
                         applicableActionExists = true;
                         res[index] = index;
                     } else {
@@ -373,6 +483,7 @@ public:
             }
 
             if (cacheApplicableActions) {
+                CacheLock lock(cacheMutex);
                 applicableActionsCache[state] = res;
             }
         }
@@ -388,6 +499,8 @@ protected:
     // Apply action 'actionIndex' to 'current', resulting in 'next'
     void calcSuccessorState(State const& current, int const& actionIndex,
                             PDState& next) const {
+        // Subformulas that are shared by several CPFs are evaluated only once
+        LogicalExpression::startMemoization();
         for (int index = 0; index < State::numberOfDeterministicStateFluents;
              ++index) {
             deterministicCPFs[index]->evaluate(
@@ -401,6 +514,44 @@ protected:
                 next.probabilisticStateFluentAsPD(index), current,
                 actionStates[actionIndex]);
         }
+        LogicalExpression::stopMemoization();
+    }
+
+    // Apply action 'actionIndex' to 'current', resulting in 'next', where
+    // 'base' is the successor of 'current' under action 'baseActionIndex'.
+    // Only CPFs that are influenced by an action fluent where the two actions
+    // differ are evaluated, and all others are copied from 'base'. This saves
+    // most CPF evaluations if a state is expanded under many actions.
+    void calcSuccessorState(State const& current, int const& actionIndex,
+                            PDState const& base, int const& baseActionIndex,
+                            PDState& next) const {
+        LogicalExpression::startMemoization();
+        for (int index = 0; index < State::numberOfDeterministicStateFluents;
+             ++index) {
+            if (deterministicCPFs[index]->actionsAreEquivalent(
+                    actionIndex, baseActionIndex)) {
+                next.deterministicStateFluent(index) =
+                    base.deterministicStateFluent(index);
+            } else {
+                deterministicCPFs[index]->evaluate(
+                    next.deterministicStateFluent(index), current,
+                    actionStates[actionIndex]);
+            }
+        }
+
+        for (int index = 0; index < State::numberOfProbabilisticStateFluents;
+             ++index) {
+            if (probabilisticCPFs[index]->actionsAreEquivalent(
+                    actionIndex, baseActionIndex)) {
+                next.probabilisticStateFluentAsPD(index) =
+                    base.probabilisticStateFluentAsPD(index);
+            } else {
+                probabilisticCPFs[index]->evaluate(
+                    next.probabilisticStateFluentAsPD(index), current,
+                    actionStates[actionIndex]);
+            }
+        }
+        LogicalExpression::stopMemoization();
     }
 
     /*****************************************************************
@@ -441,10 +592,35 @@ private:
     bool checkDeadEnd(KleeneState const& state) const;
     bool checkGoal(KleeneState const& state) const;
 
+    // A candidate for a dead end or goal region: a concrete state and the
+    // indices of its successors (where the index of a state is its position
+    // in the enumeration of all states)
+    struct RewardLockCandidate {
+        long stateIndex;
+        bdd state;
+        std::vector<long> successors;
+    };
+
+    // Removes all candidates with a successor that is not a remaining
+    // candidate, and returns the region of the remaining candidates (and
+    // their number in regionSize). Each removal is propagated once to the
+    // candidates with the removed one as successor.
+    static bdd calcGreatestFixpoint(
+        std::vector<RewardLockCandidate> const& candidates,
+        long numberOfStates, long& regionSize);
+
+    // Adds the indices of all concrete states that are described by state to
+    // indices, where the value of the i-th variable is multiplied with
+    // multipliers[i]
+    static void addStateIndices(KleeneState const& state,
+                                std::vector<long> const& multipliers,
+                                std::vector<long>& indices);
+
     // BDD related methods
-    bdd stateToBDD(KleeneState const& state) const;
-    bdd stateToBDD(State const& state) const;
-    bool BDDIncludes(bdd BDD, KleeneState const& state) const;
+    static bdd stateToBDD(KleeneState const& state);
+    static bdd stateToBDD(State const& state);
+    static bool BDDIncludes(bdd BDD, KleeneState const& state);
+    static bool BDDIncludes(bdd BDD, State const& state);
 };
 
 /*****************************************************************
@@ -464,6 +640,10 @@ public:
     // Cache for applicable reasonable actions
     static ActionHashMap applicableActionsCache;
 
+    // Protects stateValueCache and applicableActionsCache while several
+    // threads search in parallel
+    static std::mutex cacheMutex;
+
 protected:
     /*****************************************************************
                     Calculation of state transition
@@ -481,6 +661,8 @@ protected:
     // in 'next'.
     void calcSuccessorState(State const& current, int const& actionIndex,
                             State& next) const {
+        // Subformulas that are shared by several CPFs are evaluated only once
+        LogicalExpression::startMemoization();
         for (size_t index = 0; index < State::numberOfDeterministicStateFluents;
              ++index) {
             deterministicCPFs[index]->evaluate(
@@ -494,6 +676,47 @@ protected:
                 next.probabilisticStateFluent(index), current,
                 actionStates[actionIndex]);
         }
+        LogicalExpression::stopMemoization();
+
+        State::calcStateFluentHashKeys(next);
+        State::calcStateHashKey(next);
+    }
+
+    // Apply action 'actionIndex' in the determinization to 'current', resulting
+    // in 'next', where 'base' is the successor of 'current' under action
+    // 'baseActionIndex'. Only CPFs that are influenced by an action fluent
+    // where the two actions differ are evaluated, and all others are copied
+    // from 'base'.
+    void calcSuccessorState(State const& current, int const& actionIndex,
+                            State const& base, int const& baseActionIndex,
+                            State& next) const {
+        LogicalExpression::startMemoization();
+        for (size_t index = 0; index < State::numberOfDeterministicStateFluents;
+             ++index) {
+            if (deterministicCPFs[index]->actionsAreEquivalent(
+                    actionIndex, baseActionIndex)) {
+                next.deterministicStateFluent(index) =
+                    base.deterministicStateFluent(index);
+            } else {
+                deterministicCPFs[index]->evaluate(
+                    next.deterministicStateFluent(index), current,
+                    actionStates[actionIndex]);
+            }
+        }
+
+        for (size_t index = 0; index < State::numberOfProbabilisticStateFluents;
+             ++index) {
+            if (determinizedCPFs[index]->actionsAreEquivalent(
+                    actionIndex, baseActionIndex)) {
+                next.probabilisticStateFluent(index) =
+                    base.probabilisticStateFluent(index);
+            } else {
+                determinizedCPFs[index]->evaluate(
+                    next.probabilisticStateFluent(index), current,
+                    actionStates[actionIndex]);
+            }
+        }
+        LogicalExpression::stopMemoization();
 
         State::calcStateFluentHashKeys(next);
         State::calcStateHashKey(next);
@@ -511,33 +734,57 @@ protected:
     std::vector<int> getApplicableActions(State const& state) const override {
         std::vector<int> res(numberOfActions, 0);
 
-        ActionHashMap::iterator it = applicableActionsCache.find(state);
-        if (it != applicableActionsCache.end()) {
-            assert(it->second.size() == res.size());
-            for (size_t i = 0; i < res.size(); ++i) {
-                res[i] = it->second[i];
+        bool isCached = false;
+        {
+            CacheLock lock(cacheMutex);
+            ActionHashMap::iterator it = applicableActionsCache.find(state);
+            if (it != applicableActionsCache.end()) {
+                assert(it->second.size() == res.size());
+                for (size_t i = 0; i < res.size(); ++i) {
+                    res[i] = it->second[i];
+                }
+                isCached = true;
             }
-        } else {
+        }
+
+        if (!isCached) {
+            std::vector<uint64_t> applicableActionMask;
+            calcApplicableActionMask(state, applicableActionMask);
             bool applicableActionExists = false;
             if (hasUnreasonableActions) {
                 std::map<State, int, State::CompareIgnoringStepsToGo>
                     childStates;
 
+                // The successor of the first applicable action is the base
+                // for the computation of all other successors
+                State const* base = nullptr;
+                int baseActionIndex = -1;
+
                 for (size_t index = 0; index < numberOfActions; ++index) {
-                    if (actionIsApplicable(actionStates[index], state)) {
+                    if (actionIsInMask(applicableActionMask, index)) {
                         applicableActionExists = true;
                         // This action is applicable
                         State nxt;
-                        calcSuccessorState(state, index, nxt);
+                        if (base) {
+                            calcSuccessorState(state, index, *base,
+                                               baseActionIndex, nxt);
+                        } else {
+                            calcSuccessorState(state, index, nxt);
+                        }
                         State::calcStateHashKey(nxt);
 
-                        if (childStates.find(nxt) == childStates.end()) {
+                        auto it = childStates.find(nxt);
+                        if (it == childStates.end()) {
                             // This action is reasonable
-                            childStates[nxt] = index;
+                            it = childStates.emplace(nxt, index).first;
                             res[index] = index;
+                            if (!base) {
+                                base = &(it->first);
+                                baseActionIndex = index;
+                            }
                         } else {
                             // This action is not reasonable
-                            res[index] = childStates[nxt];
+                            res[index] = it->second;
                         }
                     } else {
                         // This action is not appicable
@@ -546,7 +793,7 @@ protected:
                 }
             } else {
                 for (size_t index = 0; index < numberOfActions; ++index) {
-                    if (actionIsApplicable(actionStates[index], state)) {
+                    if (actionIsInMask(applicableActionMask, index)) {
                         applicableActionExists = true;
                         res[index] = index;
                     } else {
@@ -560,6 +807,7 @@ protected:
             }
 
             if (cacheApplicableActions) {
+                CacheLock lock(cacheMutex);
                 applicableActionsCache[state] = res;
             }
         }
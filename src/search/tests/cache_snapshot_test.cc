@@ -0,0 +1,90 @@
+#include "test_utils.cc"
+
+#include "../cache_snapshot.h"
+#include "../search_engine.h"
+
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing cache snapshots") {
+    // A task with two state fluents (without perfect state hash keys) and two
+    // actions, where the reward function caches in a map and the only action
+    // precondition in a lazily filled vector
+    State::numberOfDeterministicStateFluents = 2;
+    State::numberOfProbabilisticStateFluents = 0;
+    State::stateHashingPossible = false;
+    State::stateFluentHashKeysOfDeterministicStateFluents.resize(2);
+    SearchEngine::numberOfActions = 2;
+    SearchEngine::taskHash = 42;
+
+    RewardFunction reward(nullptr, 0, 0.0, 1.0, false);
+    reward.cachingType = Evaluatable::MAP;
+    reward.evaluationCacheMap[3] = 0.5;
+    SearchEngine::rewardCPF = &reward;
+
+    DeterministicEvaluatable precond("precond", nullptr, 1);
+    precond.cachingType = Evaluatable::LAZY_VECTOR;
+    precond.evaluationCacheVector.resize(4, -std::numeric_limits<double>::max());
+    precond.evaluationCacheVector[2] = 1.0;
+    SearchEngine::actionPreconditions.push_back(&precond);
+
+    State state({1.0, 0.0}, 3);
+    ProbabilisticSearchEngine::stateValueCache[state] = 2.5;
+    DeterministicSearchEngine::applicableActionsCache[state] = {0, -1};
+
+    string file = "cache_snapshot_test.snapshot";
+    CacheSnapshot::save(file);
+
+    reward.evaluationCacheMap.clear();
+    precond.evaluationCacheVector[2] = -std::numeric_limits<double>::max();
+    ProbabilisticSearchEngine::stateValueCache.clear();
+    DeterministicSearchEngine::applicableActionsCache.clear();
+
+    SUBCASE("Loading a snapshot restores all caches") {
+        CHECK(CacheSnapshot::load(file));
+
+        CHECK(reward.evaluationCacheMap.size() == 1);
+        CHECK(reward.evaluationCacheMap[3] == doctest::Approx(0.5));
+        CHECK(precond.evaluationCacheVector[2] == doctest::Approx(1.0));
+        CHECK(precond.evaluationCacheVector[0] ==
+              -std::numeric_limits<double>::max());
+
+        CHECK(ProbabilisticSearchEngine::stateValueCache.size() == 1);
+        CHECK(ProbabilisticSearchEngine::stateValueCache[state] ==
+              doctest::Approx(2.5));
+        CHECK(ProbabilisticSearchEngine::applicableActionsCache.empty());
+        CHECK(DeterministicSearchEngine::applicableActionsCache.size() == 1);
+        CHECK(DeterministicSearchEngine::applicableActionsCache[state] ==
+              vector<int>({0, -1}));
+        CHECK(DeterministicSearchEngine::stateValueCache.empty());
+    }
+
+    SUBCASE("A snapshot of a different task is rejected") {
+        SearchEngine::taskHash = 43;
+        CHECK(!CacheSnapshot::load(file));
+
+        CHECK(reward.evaluationCacheMap.empty());
+        CHECK(precond.evaluationCacheVector[2] ==
+              -std::numeric_limits<double>::max());
+        CHECK(ProbabilisticSearchEngine::stateValueCache.empty());
+        CHECK(DeterministicSearchEngine::applicableActionsCache.empty());
+    }
+
+    SUBCASE("A missing snapshot is ignored") {
+        CHECK(!CacheSnapshot::load("cache_snapshot_test.missing"));
+    }
+
+    std::remove(file.c_str());
+    ProbabilisticSearchEngine::stateValueCache.clear();
+    DeterministicSearchEngine::applicableActionsCache.clear();
+    SearchEngine::rewardCPF = nullptr;
+    SearchEngine::taskHash = 0;
+    SearchEngine::numberOfActions = -1;
+    State::numberOfDeterministicStateFluents = 0;
+    State::stateHashingPossible = true;
+}
@@ -1,6 +1,7 @@
 #include "test_utils.cc"
 
 #include "../logical_expressions.h"
+#include "../search_engine.h"
 
 #include <sstream>
 #include <string>
@@ -543,3 +544,149 @@ TEST_CASE_FIXTURE(ProstUnitTest, "Testing function evaluation") {
         CHECK(result == doctest::Approx(5.5));
     }
 }
+
+TEST_CASE_FIXTURE(ProstUnitTest,
+                  "Testing evaluation to probability distributions") {
+    State const dummyState;
+    ActionState const dummyAction(0, {}, {});
+    string s;
+    DiscretePD result;
+    SUBCASE("Tests evaluation of conjunctions of Bernoulli distributions") {
+        s = "and(Bernoulli($c(0.5)) Bernoulli($c(0.4)))";
+        LogicalExpression* conjunct = LogicalExpression::createFromString(s);
+        conjunct->evaluateToPD(result, dummyState, dummyAction);
+        REQUIRE(result.isWellDefined());
+        CHECK(result.truthProbability() == doctest::Approx(0.2));
+
+        double truthProb = 0.0;
+        conjunct->evaluateToTruthProbability(truthProb, dummyState,
+                                             dummyAction);
+        CHECK(truthProb == doctest::Approx(0.2));
+
+        s = "and(Bernoulli($c(0.5)) $c(0))";
+        conjunct = LogicalExpression::createFromString(s);
+        conjunct->evaluateToPD(result, dummyState, dummyAction);
+        CHECK(result.isFalsity());
+
+        s = "or(Bernoulli($c(0.5)) Bernoulli($c(0.5)))";
+        LogicalExpression* disjunct = LogicalExpression::createFromString(s);
+        disjunct->evaluateToPD(result, dummyState, dummyAction);
+        REQUIRE(result.isWellDefined());
+        CHECK(result.truthProbability() == doctest::Approx(0.75));
+
+        s = "~(Bernoulli($c(0.3)))";
+        LogicalExpression* negation = LogicalExpression::createFromString(s);
+        negation->evaluateToPD(result, dummyState, dummyAction);
+        REQUIRE(result.isWellDefined());
+        CHECK(result.truthProbability() == doctest::Approx(0.7));
+    }
+    SUBCASE("Tests that arithmetic expressions merge identical outcomes") {
+        // The sum of two Bernoulli distributed variables is 1 in two cases
+        s = "+(Bernoulli($c(0.5)) Bernoulli($c(0.5)))";
+        LogicalExpression* addition = LogicalExpression::createFromString(s);
+        addition->evaluateToPD(result, dummyState, dummyAction);
+        REQUIRE(result.isWellDefined());
+        REQUIRE(result.values.size() == 3);
+        CHECK(result.values[0] == doctest::Approx(0.0));
+        CHECK(result.values[1] == doctest::Approx(1.0));
+        CHECK(result.values[2] == doctest::Approx(2.0));
+        CHECK(result.probabilities[0] == doctest::Approx(0.25));
+        CHECK(result.probabilities[1] == doctest::Approx(0.5));
+        CHECK(result.probabilities[2] == doctest::Approx(0.25));
+
+        s = "-($c(1) Bernoulli($c(0.5)) Bernoulli($c(0.5)))";
+        LogicalExpression* subtraction =
+            LogicalExpression::createFromString(s);
+        subtraction->evaluateToPD(result, dummyState, dummyAction);
+        REQUIRE(result.isWellDefined());
+        REQUIRE(result.values.size() == 3);
+        CHECK(result.values[0] == doctest::Approx(-1.0));
+        CHECK(result.values[1] == doctest::Approx(0.0));
+        CHECK(result.values[2] == doctest::Approx(1.0));
+        CHECK(result.probabilities[1] == doctest::Approx(0.5));
+
+        // Multiplication with a negative number reverses the order of values
+        s = "*(Discrete(($c(1) : $c(0.2)) ($c(2) : $c(0.3)) ($c(3) : $c(0.5)))"
+            " Discrete(($c(-1) : $c(0.5)) ($c(1) : $c(0.5))))";
+        LogicalExpression* multiplication =
+            LogicalExpression::createFromString(s);
+        multiplication->evaluateToPD(result, dummyState, dummyAction);
+        REQUIRE(result.isWellDefined());
+        REQUIRE(result.values.size() == 6);
+        CHECK(result.values[0] == doctest::Approx(-3.0));
+        CHECK(result.values[5] == doctest::Approx(3.0));
+        CHECK(result.probabilities[0] == doctest::Approx(0.25));
+        CHECK(result.probabilities[3] == doctest::Approx(0.1));
+    }
+    SUBCASE("Tests evaluation of discrete distributions and multiconditions") {
+        s = "Discrete(($c(2) : $c(0.3)) ($c(1) : $c(0.2)) ($c(2) : $c(0.5)))";
+        LogicalExpression* discrete = LogicalExpression::createFromString(s);
+        discrete->evaluateToPD(result, dummyState, dummyAction);
+        REQUIRE(result.isWellDefined());
+        REQUIRE(result.values.size() == 2);
+        CHECK(result.values[0] == doctest::Approx(1.0));
+        CHECK(result.probabilities[0] == doctest::Approx(0.2));
+        CHECK(result.values[1] == doctest::Approx(2.0));
+        CHECK(result.probabilities[1] == doctest::Approx(0.8));
+
+        // if Bernoulli(0.4) then 3 else if 0 then 5 else 1
+        s = "switch( (Bernoulli($c(0.4)) : $c(3)) ($c(0) : $c(5))"
+            " ($c(1) : $c(1)))";
+        LogicalExpression* multicond = LogicalExpression::createFromString(s);
+        multicond->evaluateToPD(result, dummyState, dummyAction);
+        REQUIRE(result.isWellDefined());
+        REQUIRE(result.values.size() == 2);
+        CHECK(result.values[0] == doctest::Approx(1.0));
+        CHECK(result.probabilities[0] == doctest::Approx(0.6));
+        CHECK(result.values[1] == doctest::Approx(3.0));
+        CHECK(result.probabilities[1] == doctest::Approx(0.4));
+    }
+}
+
+TEST_CASE_FIXTURE(ProstUnitTest, "Testing shared subformulas") {
+    State::numberOfDeterministicStateFluents = 2;
+    SearchEngine::stateFluents.push_back(
+        new DeterministicStateFluent(0, "x", {}));
+    SearchEngine::stateFluents.push_back(
+        new DeterministicStateFluent(1, "y", {}));
+    ActionState const dummyAction(0, {}, {});
+    State const both({1.0, 1.0}, {}, 1);
+    State const onlyX({1.0, 0.0}, {}, 1);
+    double result = 0.0;
+
+    SUBCASE("Identical subformulas are created only once") {
+        string s = "and($s(0) $s(1))";
+        LogicalExpression* first = LogicalExpression::createFromString(s);
+        s = " and($s(0) $s(1))";
+        LogicalExpression* second = LogicalExpression::createFromString(s);
+        CHECK(first == second);
+
+        s = "or($s(0) $s(1))";
+        LogicalExpression* other = LogicalExpression::createFromString(s);
+        CHECK(first != other);
+    }
+    SUBCASE("Memoized results are only reused until memoization stops") {
+        string s = "+(and($s(0) $s(1)) *($c(2) and($s(0) $s(1))))";
+        LogicalExpression* sum = LogicalExpression::createFromString(s);
+
+        LogicalExpression::startMemoization();
+        sum->evaluate(result, both, dummyAction);
+        CHECK(result == doctest::Approx(3.0));
+        LogicalExpression::stopMemoization();
+
+        LogicalExpression::startMemoization();
+        sum->evaluate(result, onlyX, dummyAction);
+        CHECK(result == doctest::Approx(0.0));
+
+        DiscretePD pd;
+        sum->evaluateToPD(pd, onlyX, dummyAction);
+        CHECK(pd.isDeterministic());
+        CHECK(pd.values[0] == doctest::Approx(0.0));
+        LogicalExpression::stopMemoization();
+
+        sum->evaluate(result, both, dummyAction);
+        CHECK(result == doctest::Approx(3.0));
+    }
+
+    State::numberOfDeterministicStateFluents = 0;
+}
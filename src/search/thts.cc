@@ -6,10 +6,16 @@
 #include "outcome_selection.h"
 #include "recommendation_function.h"
 
+#include "utils/cache_lock.h"
 #include "utils/logger.h"
 #include "utils/system_utils.h"
 
+#include <algorithm>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
+
+THTS::PolicyHashMap THTS::policyCache(62233);
 
 std::string SearchNode::toString() const {
     std::stringstream ss;
@@ -35,29 +41,60 @@ THTS::THTS(std::string _name)
       stepsToGoInCurrentState(SearchEngine::horizon),
       stepsToGoInNextState(SearchEngine::horizon - 1),
       appliedActionIndex(-1),
+      appliedActionNode(nullptr),
       trialReward(0.0),
       currentTrial(0),
       initializedDecisionNodes(0),
       lastUsedNodePoolIndex(0),
+      childrenMemory(0),
+      memoryExhausted(false),
       terminationMethod(THTS::TIME),
       maxNumberOfTrials(0),
       numberOfNewDecisionNodesPerTrial(1),
+      maxTreeMemory(std::numeric_limits<long>::max()),
+      stabilityThreshold(0.0),
+      numberOfThreads(1),
+      useSharedTree(false),
+      reuseTree(false),
+      useTranspositions(false),
+      useJointOutcomes(false),
+      batchSize(1),
+      sharedTreeOwner(nullptr),
+      transpositionTable(SearchEngine::horizon + 1),
+      trialDeferred(false),
+      lastExecutedActionIndex(-1),
       cacheHits(0),
+      reusedNodes(0),
+      transpositions(0),
+      batchedInitializations(0),
+      terminatedEarly(false),
       uniquePolicyDueToLastAction(false),
       uniquePolicyDueToRewardLock(false),
       uniquePolicyDueToPreconds(false),
+      uniquePolicyDueToSolvedState(false),
       stepsToGoInFirstSolvedState(-1),
       expectedRewardInFirstSolvedState(-std::numeric_limits<double>::max()),
       numTrialsInFirstRelevantState(-1),
       numSearchNodesInFirstRelevantState(-1),
       numRewardLockStates(0),
-      numSingleApplicableActionStates(0) {
+      numSingleApplicableActionStates(0),
+      numSolvedPolicyStates(0) {
     setMaxNumberOfNodes(24000000);
     setTimeout(1.0);
     setRecommendationFunction(new ExpectedBestArmRecommendation(this));
 }
 
 bool THTS::setValueFromString(std::string& param, std::string& value) {
+    if (param == "-threads") {
+        setNumberOfThreads(atoi(value.c_str()));
+        return numberOfThreads > 0;
+    } else if (param == "-shared-tree") {
+        setUseSharedTree(atoi(value.c_str()));
+        return true;
+    }
+    // Remember all other parameters to configure the workers with them
+    parameters.emplace_back(param, value);
+
     // Check if this parameter encodes an ingredient
     if (param == "-act") {
         setActionSelection(ActionSelection::fromString(value, this));
@@ -106,6 +143,32 @@ bool THTS::setValueFromString(std::string& param, std::string& value) {
     } else if (param == "-node-limit") {
         setMaxNumberOfNodes(atoi(value.c_str()));
         return true;
+    } else if (param == "-tree-mem") {
+        // The budget is given in KB (like the RAM limit of the planner) or
+        // with one of the suffixes K, M and G
+        long kiloBytes = atol(value.c_str());
+        if (value.back() == 'M') {
+            kiloBytes *= 1024;
+        } else if (value.back() == 'G') {
+            kiloBytes *= 1024 * 1024;
+        }
+        setMaxTreeMemory(kiloBytes * 1024);
+        return kiloBytes > 0;
+    } else if (param == "-stable") {
+        setStabilityThreshold(atof(value.c_str()));
+        return true;
+    } else if (param == "-reuse") {
+        setReuseTree(atoi(value.c_str()));
+        return true;
+    } else if (param == "-transpositions") {
+        setUseTranspositions(atoi(value.c_str()));
+        return true;
+    } else if (param == "-joint-outcomes") {
+        setUseJointOutcomes(atoi(value.c_str()));
+        return true;
+    } else if (param == "-batch") {
+        setBatchSize(atoi(value.c_str()));
+        return batchSize > 0;
     }
 
     return SearchEngine::setValueFromString(param, value);
@@ -154,6 +217,18 @@ void THTS::disableCaching() {
     initializer->disableCaching();
     recommendationFunction->disableCaching();
     SearchEngine::disableCaching();
+
+    // No solved states are cached from now on, so the memory of the policy
+    // cache is released
+    {
+        CacheLock lock(ProbabilisticSearchEngine::cacheMutex);
+        PolicyHashMap tmp;
+        policyCache.swap(tmp);
+    }
+
+    for (THTS* worker : workers) {
+        worker->disableCaching();
+    }
 }
 
 void THTS::initSession() {
@@ -171,6 +246,79 @@ void THTS::initSession() {
     backupFunction->initSession();
     initializer->initSession();
     recommendationFunction->initSession();
+
+    // A shared tree is owned by the main search engine, and the workers have
+    // no tree of their own that could be reused
+    if (reuseTree && useSharedTree && (numberOfThreads > 1)) {
+        SystemUtils::abort(
+            "Tree reuse is not supported if the tree is shared among threads!");
+    }
+
+    // The joint outcomes of an action node are only known to the thread that
+    // created them
+    if (useJointOutcomes && useSharedTree && (numberOfThreads > 1)) {
+        SystemUtils::abort(
+            "Joint outcomes are not supported if the tree is shared among "
+            "threads!");
+    }
+
+    // If initializations are batched, the workers initialize nodes of the
+    // tree of this search engine, and these are allocated in the node pools of
+    // the workers
+    if (batchInitializations() && useSharedTree && (numberOfThreads > 1)) {
+        SystemUtils::abort(
+            "Batched initializations are not supported if the tree is shared "
+            "among threads!");
+    }
+    if (batchInitializations() && reuseTree && (numberOfThreads > 1)) {
+        SystemUtils::abort(
+            "Tree reuse is not supported if initializations are batched among "
+            "threads!");
+    }
+
+    // Transpositions are detected based on the hash key of states
+    if (useTranspositions && !State::stateHashingPossible) {
+        Logger::logLine("Transpositions are not detected since states cannot "
+                        "be hashed",
+                        Verbosity::NORMAL);
+        useTranspositions = false;
+    }
+    if (useJointOutcomes && !State::stateHashingPossible) {
+        Logger::logLine("Joint outcomes are not used since states cannot be "
+                        "hashed",
+                        Verbosity::NORMAL);
+        useJointOutcomes = false;
+    }
+
+    if (numberOfThreads > 1) {
+        // The node limit and the memory budget are shared among all trees
+        setMaxNumberOfNodes(maxNumberOfNodes / numberOfThreads);
+        if (maxTreeMemory < std::numeric_limits<long>::max()) {
+            setMaxTreeMemory(maxTreeMemory / numberOfThreads);
+        }
+        for (int i = 1; i < numberOfThreads; ++i) {
+            THTS* worker = new THTS(name);
+            for (auto const& parameter : parameters) {
+                std::string param = parameter.first;
+                std::string value = parameter.second;
+                worker->setValueFromString(param, value);
+            }
+            worker->setMaxNumberOfNodes(maxNumberOfNodes);
+            worker->setMaxTreeMemory(maxTreeMemory);
+            if (useSharedTree) {
+                worker->sharedTreeOwner = this;
+            }
+            worker->setTimeout(timeout);
+            if (!cachingEnabled) {
+                worker->disableCaching();
+            }
+            // The heuristic is only learned once (by this search engine), so
+            // all threads use the same configuration
+            worker->initializer->adoptLearnedParameters(initializer);
+            worker->initSession();
+            workers.push_back(worker);
+        }
+    }
 }
 
 void THTS::initRound() {
@@ -181,12 +329,20 @@ void THTS::initRound() {
     numSearchNodesInFirstRelevantState = -1;
     numRewardLockStates = 0;
     numSingleApplicableActionStates = 0;
+    numSolvedPolicyStates = 0;
+
+    // The tree of the last step of the previous round is not reused
+    lastExecutedActionIndex = -1;
 
     // Notify ingredients of new round
     actionSelection->initRound();
     outcomeSelection->initRound();
     backupFunction->initRound();
     initializer->initRound();
+
+    for (THTS* worker : workers) {
+        worker->initRound();
+    }
 }
 
 void THTS::finishRound() {
@@ -195,9 +351,17 @@ void THTS::finishRound() {
     outcomeSelection->finishRound();
     backupFunction->finishRound();
     initializer->finishRound();
+
+    for (THTS* worker : workers) {
+        worker->finishRound();
+    }
 }
 
 void THTS::initStep(State const& current) {
+    // The subtree must be determined before the states of the last step are
+    // overwritten
+    SearchNode* reusedRootNode = findReusableSubtree(current);
+
     PDState rootState(current);
     // Adjust maximal search depth and set root state
     if (rootState.stepsToGo() > maxSearchDepth) {
@@ -220,19 +384,45 @@ void THTS::initStep(State const& current) {
 
     // Reset per step statistics
     cacheHits = 0;
+    reusedNodes = 0;
+    transpositions = 0;
+    batchedInitializations = 0;
+    terminatedEarly = false;
     lastSearchTime = 0.0;
     uniquePolicyDueToLastAction = false;
     uniquePolicyDueToRewardLock = false;
     uniquePolicyDueToPreconds = false;
+    uniquePolicyDueToSolvedState = false;
 
-    // Create root node
-    currentRootNode = createRootNode();
+    // Create root node (a worker that searches in a shared tree still resets
+    // its node pool, but uses the root node of the owner of the tree)
+    if (reusedRootNode) {
+        reuseSubtree(reusedRootNode);
+        currentRootNode = reusedRootNode;
+    } else {
+        currentRootNode = createRootNode();
+    }
+    if (sharedTreeOwner) {
+        currentRootNode = sharedTreeOwner->currentRootNode;
+    }
 
     // Notify ingredients of new step
     actionSelection->initStep(current);
     outcomeSelection->initStep();
     backupFunction->initStep();
     initializer->initStep(current);
+
+    for (THTS* worker : workers) {
+        worker->initStep(current);
+    }
+}
+
+void THTS::setExecutedAction(int actionIndex) {
+    lastExecutedActionIndex = actionIndex;
+
+    for (THTS* worker : workers) {
+        worker->setExecutedAction(actionIndex);
+    }
 }
 
 void THTS::finishStep() {
@@ -240,12 +430,18 @@ void THTS::finishStep() {
         ++numRewardLockStates;
     } else if (uniquePolicyDueToPreconds) {
         ++numSingleApplicableActionStates;
+    } else if (uniquePolicyDueToSolvedState) {
+        ++numSolvedPolicyStates;
     }
 
     actionSelection->finishStep();
     outcomeSelection->finishStep();
     backupFunction->finishStep();
     initializer->finishStep();
+
+    for (THTS* worker : workers) {
+        worker->finishStep();
+    }
 }
 
 inline void THTS::initTrial() {
@@ -258,6 +454,15 @@ inline void THTS::initTrial() {
     initializedDecisionNodes = 0;
     trialReward = 0.0;
     tipNodeOfTrial = nullptr;
+    trialPath.clear();
+    memoryExhausted = (getTreeMemory() >= maxTreeMemory);
+    if (batchInitializations()) {
+        // Workers allocate the children of the nodes they initialize
+        for (THTS const* worker : workers) {
+            memoryExhausted = memoryExhausted || (worker->getTreeMemory() >=
+                                                  worker->maxTreeMemory);
+        }
+    }
 
     // Notify ingredients of new trial
     actionSelection->initTrial();
@@ -288,14 +493,58 @@ void THTS::estimateBestActions(State const& _rootState,
 
         // Update statistics
         if ((stepsToGoInFirstSolvedState == -1) &&
-            (uniquePolicyDueToLastAction || uniquePolicyDueToRewardLock)) {
+            (uniquePolicyDueToLastAction || uniquePolicyDueToRewardLock ||
+             uniquePolicyDueToSolvedState)) {
             stepsToGoInFirstSolvedState = stepsToGo;
-            // expectedRewardInFirstSolvedState = TODO!
+            // The expected reward is only known if the state has been solved
+            // in a search (TODO: compute it in the other cases)
+            double value = 0.0;
+            if (uniquePolicyDueToSolvedState &&
+                lookUpSolvedState(states[stepsToGoInCurrentState], value)) {
+                expectedRewardInFirstSolvedState = value;
+            }
         }
 
         return;
     }
 
+    if (batchInitializations()) {
+        performBatchedTrials();
+        recommendationFunction->recommend(currentRootNode, bestActions);
+    } else if (workers.empty()) {
+        performTrials();
+        recommendationFunction->recommend(currentRootNode, bestActions);
+    } else if (useSharedTree) {
+        performTrialsInParallel();
+        recommendationFunction->recommend(currentRootNode, bestActions);
+    } else {
+        performTrialsInParallel();
+        recommendFromAllTrees(bestActions);
+    }
+    assert(!bestActions.empty());
+
+    // Update statistics
+    if (currentRootNode->solved && (stepsToGoInFirstSolvedState == -1)) {
+        // This is the first root state that was solved, so everything that
+        // could happen in the future is also solved, and the optimal actions
+        // of all states of the policy have been stored in the policy cache
+        stepsToGoInFirstSolvedState = stepsToGo;
+        expectedRewardInFirstSolvedState =
+            currentRootNode->getExpectedRewardEstimate();
+    }
+
+    if (numTrialsInFirstRelevantState < 0 && currentTrial > 0) {
+        numTrialsInFirstRelevantState = currentTrial;
+    }
+    if (numSearchNodesInFirstRelevantState < 0 && lastUsedNodePoolIndex > 0) {
+        numSearchNodesInFirstRelevantState = lastUsedNodePoolIndex;
+    }
+
+    // Memorize search time
+    lastSearchTime = stopwatch();
+}
+
+void THTS::performTrials() {
     // Perform trials until some termination criterion is fullfilled
     while (moreTrials()) {
         // Logger::logSeparator(Verbosity::DEBUG);
@@ -314,30 +563,213 @@ void THTS::estimateBestActions(State const& _rootState,
         // }
         // assert(currentTrial != 100);
     }
+}
 
-    recommendationFunction->recommend(currentRootNode, bestActions);
-    assert(!bestActions.empty());
+void THTS::performBatchedTrials() {
+    while (moreTrials()) {
+        // Perform trials until batchSize of them wait for the initialization
+        // of a node (trials that end for another reason are complete)
+        while ((static_cast<int>(pendingInitializations.size()) < batchSize) &&
+               moreTrials()) {
+            visitDecisionNode(currentRootNode);
+            ++currentTrial;
+        }
+        initializeBatch();
+        completeBatchedTrials();
+    }
+}
 
-    // Update statistics
-    if (currentRootNode->solved && (stepsToGoInFirstSolvedState == -1)) {
-        // TODO: This is the first root state that was solved, so everything
-        //  that could happen in the future is also solved. We should (at least
-        //  in this case) make sure that we keep the tree and simply follow the
-        //  optimal policy.
-        stepsToGoInFirstSolvedState = stepsToGo;
-        expectedRewardInFirstSolvedState =
-            currentRootNode->getExpectedRewardEstimate();
+void THTS::deferInitialization(SearchNode* node) {
+    // The trial is unwound without backups, which are performed once the
+    // node has been initialized
+    PendingInitialization pending = {node, states[stepsToGoInCurrentState],
+                                     trialPath};
+    pendingInitializations.push_back(std::move(pending));
+    trialDeferred = true;
+}
+
+void THTS::initializeBatch() {
+    // Several trials might wait for the same node, which is initialized once
+    std::vector<PendingInitialization const*> nodesToInitialize;
+    std::vector<bool> isLeaf;
+    std::unordered_set<SearchNode const*> distinctNodes;
+    for (PendingInitialization const& pending : pendingInitializations) {
+        if (distinctNodes.insert(pending.node).second) {
+            nodesToInitialize.push_back(&pending);
+            isLeaf.push_back(pending.node->children.empty());
+        }
     }
 
-    if (numTrialsInFirstRelevantState < 0 && currentTrial > 0) {
-        numTrialsInFirstRelevantState = currentTrial;
+    // The nodes are distributed among this search engine and the workers,
+    // which initialize them simultaneously with their own initializers
+    std::vector<THTS*> engines(1, this);
+    engines.insert(engines.end(), workers.begin(), workers.end());
+    int numberOfEngines = engines.size();
+    auto initializeNodes = [&nodesToInitialize, numberOfEngines](
+                               THTS* engine, int first) {
+        for (size_t i = first; i < nodesToInitialize.size();
+             i += numberOfEngines) {
+            SearchNode* node = nodesToInitialize[i]->node;
+            engine->stepsToGoInCurrentState = node->stepsToGo;
+            engine->initializer->initialize(node, nodesToInitialize[i]->state);
+        }
+    };
+
+    if (workers.empty() || (nodesToInitialize.size() == 1)) {
+        initializeNodes(this, 0);
+    } else {
+        CacheLock::parallelSearch = true;
+        std::vector<std::thread> threads;
+        for (int i = 1; i < numberOfEngines; ++i) {
+            int seed =
+                MathUtils::rnd->genInt(0, std::numeric_limits<int>::max());
+            THTS* worker = engines[i];
+            threads.emplace_back([&initializeNodes, worker, seed, i]() {
+                MathUtils::rnd->seed(seed);
+                initializeNodes(worker, i);
+            });
+        }
+        initializeNodes(this, 0);
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        CacheLock::parallelSearch = false;
     }
-    if (numSearchNodesInFirstRelevantState < 0 && lastUsedNodePoolIndex > 0) {
-        numSearchNodesInFirstRelevantState = lastUsedNodePoolIndex;
+
+    for (size_t i = 0; i < nodesToInitialize.size(); ++i) {
+        SearchNode* node = nodesToInitialize[i]->node;
+        if (isLeaf[i]) {
+            countChildrenMemory(node);
+        }
+        if (useTranspositions && node->initialized) {
+            transpositionTable[node->stepsToGo].emplace(
+                nodesToInitialize[i]->state.hashKey, node);
+        }
     }
+    batchedInitializations += nodesToInitialize.size();
+}
 
-    // Memorize search time
-    lastSearchTime = stopwatch();
+void THTS::completeBatchedTrials() {
+    for (PendingInitialization const& pending : pendingInitializations) {
+        // Repeat the backups of the trial that have been skipped when it was
+        // deferred (the state values of solved nodes are not cached, as the
+        // states of the trial are not available anymore)
+        SearchNode* node = pending.node;
+        std::vector<std::pair<SearchNode*, bool>> const& path = pending.path;
+        tipNodeOfTrial = node;
+        trialReward = node->getExpectedRewardEstimate();
+        backupFunction->initTrial();
+
+        // The last node of the path is the initialized node itself
+        assert(path.back().first == node);
+        for (int i = static_cast<int>(path.size()) - 2; i >= 0; --i) {
+            SearchNode* pathNode = path[i].first;
+            if (path[i].second) {
+                --path[i + 1].first->virtualLoss;
+                backupFunction->backupDecisionNode(pathNode);
+                trialReward += pathNode->immediateReward;
+            } else {
+                backupFunction->backupChanceNode(pathNode, trialReward);
+            }
+        }
+    }
+    pendingInitializations.clear();
+}
+
+void THTS::performTrialsInParallel() {
+    // The caches that are shared among all search engines must be locked
+    // while more than one thread is running
+    CacheLock::parallelSearch = true;
+
+    std::vector<std::thread> threads;
+    for (THTS* worker : workers) {
+        // Each thread has its own random number generator, which is seeded
+        // from the main generator to keep runs with a fixed seed reproducible
+        int seed = MathUtils::rnd->genInt(0, std::numeric_limits<int>::max());
+        threads.emplace_back([worker, seed]() {
+            MathUtils::rnd->seed(seed);
+            worker->stopwatch.reset();
+            worker->performTrials();
+        });
+    }
+    performTrials();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CacheLock::parallelSearch = false;
+}
+
+void THTS::recommendFromAllTrees(std::vector<int>& bestActions) {
+    // If one of the trees solved the root state, its recommendation is optimal
+    if (currentRootNode->solved) {
+        recommendationFunction->recommend(currentRootNode, bestActions);
+        return;
+    }
+    for (THTS* worker : workers) {
+        if (worker->currentRootNode->solved) {
+            worker->recommendationFunction->recommend(worker->currentRootNode,
+                                                      bestActions);
+            return;
+        }
+    }
+
+    // Otherwise, the root nodes are combined such that the visits of each
+    // action node are summed up and their reward estimates are averaged
+    // (weighted by the number of visits)
+    SearchNode mergedRoot(1.0, currentRootNode->stepsToGo);
+    mergedRoot.children.resize(currentRootNode->children.size(), nullptr);
+    mergedRoot.initialized = true;
+
+    std::vector<SearchNode const*> roots(1, currentRootNode);
+    for (THTS* worker : workers) {
+        roots.push_back(worker->currentRootNode);
+    }
+
+    for (size_t index = 0; index < mergedRoot.children.size(); ++index) {
+        SearchNode* merged = nullptr;
+        double weightedReward = 0.0;
+        double unweightedReward = 0.0;
+        int numberOfTrees = 0;
+        for (SearchNode const* root : roots) {
+            SearchNode const* child = root->children[index];
+            if (!child || !child->initialized) {
+                continue;
+            }
+            if (!merged) {
+                merged = new SearchNode(child->prob, child->stepsToGo);
+                merged->immediateReward = child->immediateReward;
+                merged->initialized = true;
+            }
+            if (child->solved) {
+                merged->solved = true;
+                merged->futureReward = child->getExpectedFutureRewardEstimate();
+            }
+            merged->numberOfVisits += child->numberOfVisits;
+            weightedReward += child->numberOfVisits * child->futureReward;
+            unweightedReward += child->futureReward;
+            ++numberOfTrees;
+        }
+
+        if (merged) {
+            // The future reward of a solved node is exact and not averaged
+            if (!merged->solved && (merged->numberOfVisits > 0)) {
+                merged->futureReward = weightedReward / merged->numberOfVisits;
+            } else if (!merged->solved) {
+                merged->futureReward = unweightedReward / numberOfTrees;
+            }
+            mergedRoot.numberOfVisits += merged->numberOfVisits;
+        }
+        mergedRoot.children[index] = merged;
+    }
+
+    recommendationFunction->recommend(&mergedRoot, bestActions);
+
+    // The merged nodes are not part of a block of search nodes
+    for (SearchNode* merged : mergedRoot.children) {
+        delete merged;
+    }
 }
 
 bool THTS::moreTrials() {
@@ -346,11 +778,26 @@ bool THTS::moreTrials() {
         (lastUsedNodePoolIndex >= maxNumberOfNodes)) {
         return false;
     }
+    if (batchInitializations()) {
+        // Workers allocate the children of the nodes they initialize
+        for (THTS const* worker : workers) {
+            if (worker->lastUsedNodePoolIndex >= worker->maxNumberOfNodes) {
+                return false;
+            }
+        }
+    }
 
     if (currentTrial == 0) {
         return true;
     }
 
+    if ((stabilityThreshold > 0.0) &&
+        ((currentTrial % stabilityCheckInterval) == 0) &&
+        recommendationIsStable()) {
+        terminatedEarly = true;
+        return false;
+    }
+
     // Check selected termination criterion
     switch (terminationMethod) {
     case THTS::TIME:
@@ -374,12 +821,34 @@ bool THTS::moreTrials() {
     return true;
 }
 
+bool THTS::recommendationIsStable() const {
+    SearchNode const* bestChild = nullptr;
+    int numberOfVisits = 0;
+    for (SearchNode const* child : currentRootNode->children) {
+        if (child && child->initialized) {
+            numberOfVisits += child->numberOfVisits;
+            if (!bestChild || MathUtils::doubleIsGreater(
+                                  child->getExpectedRewardEstimate(),
+                                  bestChild->getExpectedRewardEstimate())) {
+                bestChild = child;
+            }
+        }
+    }
+    return bestChild && (bestChild->numberOfVisits >=
+                         stabilityThreshold * numberOfVisits);
+}
+
 void THTS::visitDecisionNode(SearchNode* node) {
+    // The node is locked until it is initialized, as other threads might visit
+    // it simultaneously if the tree is shared
+    std::unique_lock<SearchNode> nodeLock(*node);
     if (node == currentRootNode) {
         initTrial();
+        addToTrialPath(node, true);
     } else {
         // Continue trial (i.e., set next state to be the current)
         initTrialStep();
+        addToTrialPath(node, true);
 
         // Check if there is a "special" reason to stop this trial (currently,
         // this is the case if the state value of the current state is cached,
@@ -392,18 +861,39 @@ void THTS::visitDecisionNode(SearchNode* node) {
         }
     }
 
-    // Initialize node if necessary
+    // Initialize node if necessary (a node that shares the children of a
+    // transposition is not counted as newly initialized, as the trial has not
+    // reached any unknown state)
     if (!node->initialized) {
         if (!tipNodeOfTrial) {
             tipNodeOfTrial = node;
         }
 
-        initializer->initialize(node, states[stepsToGoInCurrentState]);
+        bool isLeaf = node->children.empty();
+        if (!useTranspositions || !initializeFromTransposition(node)) {
+            if (batchInitializations() && (node != currentRootNode)) {
+                // The trial ends here, and it is completed once the node has
+                // been initialized together with the rest of the batch
+                deferInitialization(node);
+                return;
+            }
+            initializer->initialize(node, states[stepsToGoInCurrentState]);
+
+            if (node != currentRootNode) {
+                ++initializedDecisionNodes;
+            }
 
-        if (node != currentRootNode) {
-            ++initializedDecisionNodes;
+            if (useTranspositions && node->initialized) {
+                State const& current = states[stepsToGoInCurrentState];
+                transpositionTable[stepsToGoInCurrentState].emplace(
+                    current.hashKey, node);
+            }
+        }
+        if (isLeaf) {
+            countChildrenMemory(node);
         }
     }
+    nodeLock.unlock();
 
     // Logger::logLine("Current state is:", Verbosity::DEBUG);
     // Logger::logLine(states[stepsToGoInCurrentState].toString(),
@@ -411,12 +901,17 @@ void THTS::visitDecisionNode(SearchNode* node) {
     // Logger::logLine("Reward is " + std::to_string(node->immediateReward),
     //             Verbosity::DEBUG);
 
-    // Determine if we continue with this trial
-    if (continueTrial(node)) {
+    // Determine if we continue with this trial (if several threads search in
+    // the same tree, all children might have been solved by other threads
+    // that have not yet labeled this node as solved)
+    bool unsolvedChildExists =
+        !solvedNodesMightBeUnlabeled() || hasUnsolvedChild(node);
+    if (continueTrial(node) && unsolvedChildExists) {
         // Select the action that is simulated
         appliedActionIndex = actionSelection->selectAction(node);
         assert(node->children[appliedActionIndex]);
-        assert(!node->children[appliedActionIndex]->solved);
+        assert(solvedNodesMightBeUnlabeled() ||
+               !node->children[appliedActionIndex]->solved);
 
         // Logger::logLine("Chosen action is: " +
         //                 SearchEngine::actionStates[appliedActionIndex].toCompactString(),
@@ -448,32 +943,57 @@ void THTS::visitDecisionNode(SearchNode* node) {
         // Start outcome selection with the first probabilistic variable
         chanceNodeVarIndex = 0;
 
-        // Continue trial with chance nodes
+        // Continue trial with chance nodes. The virtual loss discourages
+        // other threads (or other trials of the same batch) from selecting the
+        // same action simultaneously.
+        SearchNode* actionNode = node->children[appliedActionIndex];
+        appliedActionNode = actionNode;
+        if (useVirtualLoss()) {
+            ++actionNode->virtualLoss;
+        }
         if (lastProbabilisticVarIndex < 0) {
-            visitDummyChanceNode(node->children[appliedActionIndex]);
+            visitDummyChanceNode(actionNode);
+        } else if (useJointOutcomes) {
+            visitJointChanceNode(actionNode);
         } else {
-            visitChanceNode(node->children[appliedActionIndex]);
+            visitChanceNode(actionNode);
+        }
+        if (trialDeferred) {
+            // The virtual loss is kept until the trial is completed
+            if (node == currentRootNode) {
+                trialDeferred = false;
+            }
+            return;
+        }
+        if (useVirtualLoss()) {
+            --actionNode->virtualLoss;
         }
 
         // Backup this node
+        nodeLock.lock();
         backupFunction->backupDecisionNode(node);
+        nodeLock.unlock();
         trialReward += node->immediateReward;
 
         // If the backup function labeled the node as solved, we store the
         // result for the associated state in case we encounter it somewhere
-        // else in the tree in the future
-        if (node->solved) {
-            if (cachingEnabled &&
-                ProbabilisticSearchEngine::stateValueCache.find(
-                    states[node->stepsToGo]) ==
-                    ProbabilisticSearchEngine::stateValueCache.end()) {
-                ProbabilisticSearchEngine::stateValueCache
-                    [states[node->stepsToGo]] =
-                        node->getExpectedFutureRewardEstimate();
-            }
+        // else in the tree (or as root state) in the future
+        if (node->solved && cachingEnabled) {
+            cacheSolvedState(node, states[node->stepsToGo]);
         }
     } else {
         // The trial is finished
+        if (!tipNodeOfTrial) {
+            tipNodeOfTrial = node;
+        }
+
+        // If the children of a transposition have been solved via another
+        // path, this node is labeled as solved by backing it up
+        if (useTranspositions && !unsolvedChildExists && !node->solved) {
+            nodeLock.lock();
+            backupFunction->backupDecisionNode(node);
+            nodeLock.unlock();
+        }
         trialReward = node->getExpectedRewardEstimate();
     }
 }
@@ -488,12 +1008,9 @@ bool THTS::currentStateIsSolved(SearchNode* node) {
         trialReward += node->immediateReward;
 
         return true;
-    } else if (ProbabilisticSearchEngine::stateValueCache.find(
-                   states[stepsToGoInCurrentState]) !=
-               ProbabilisticSearchEngine::stateValueCache.end()) {
+    } else if (lookUpSolvedState(states[stepsToGoInCurrentState],
+                                 trialReward)) {
         // This state has already been solved before
-        trialReward = ProbabilisticSearchEngine::stateValueCache
-            [states[stepsToGoInCurrentState]];
         backupFunction->backupDecisionNodeLeaf(node, trialReward);
         trialReward += node->immediateReward;
 
@@ -510,9 +1027,12 @@ bool THTS::currentStateIsSolved(SearchNode* node) {
         trialReward += node->immediateReward;
 
         if (cachingEnabled) {
-            assert(ProbabilisticSearchEngine::stateValueCache.find(
+            CacheLock lock(ProbabilisticSearchEngine::cacheMutex);
+            // Another thread might have solved the state in the meantime
+            assert(CacheLock::parallelSearch ||
+                   ProbabilisticSearchEngine::stateValueCache.find(
                        states[stepsToGoInCurrentState]) ==
-                   ProbabilisticSearchEngine::stateValueCache.end());
+                       ProbabilisticSearchEngine::stateValueCache.end());
             ProbabilisticSearchEngine::stateValueCache
                 [states[stepsToGoInCurrentState]] =
                     node->getExpectedFutureRewardEstimate();
@@ -522,16 +1042,93 @@ bool THTS::currentStateIsSolved(SearchNode* node) {
     return false;
 }
 
+bool THTS::lookUpSolvedState(State const& state, double& value) {
+    CacheLock lock(ProbabilisticSearchEngine::cacheMutex);
+    ProbabilisticSearchEngine::StateValueHashMap::const_iterator it =
+        ProbabilisticSearchEngine::stateValueCache.find(state);
+    if (it == ProbabilisticSearchEngine::stateValueCache.end()) {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+void THTS::cacheSolvedState(SearchNode const* node, State const& state) {
+    // The optimal action is the one with the highest value, as all children of
+    // a solved node are solved as well
+    int bestActionIndex = -1;
+    double bestValue = -std::numeric_limits<double>::max();
+    for (size_t index = 0; index < node->children.size(); ++index) {
+        SearchNode const* child = node->children[index];
+        if (child && child->initialized &&
+            MathUtils::doubleIsGreater(child->getExpectedRewardEstimate(),
+                                       bestValue)) {
+            bestActionIndex = index;
+            bestValue = child->getExpectedRewardEstimate();
+        }
+    }
+
+    CacheLock lock(ProbabilisticSearchEngine::cacheMutex);
+    if (ProbabilisticSearchEngine::stateValueCache.find(state) ==
+        ProbabilisticSearchEngine::stateValueCache.end()) {
+        ProbabilisticSearchEngine::stateValueCache[state] =
+            node->getExpectedFutureRewardEstimate();
+    }
+    if (bestActionIndex >= 0) {
+        policyCache.emplace(state, bestActionIndex);
+    }
+}
+
+bool THTS::lookUpSolvedPolicy(State const& state, int& actionIndex) {
+    CacheLock lock(ProbabilisticSearchEngine::cacheMutex);
+    PolicyHashMap::const_iterator it = policyCache.find(state);
+    if (it == policyCache.end()) {
+        return false;
+    }
+    actionIndex = it->second;
+    return true;
+}
+
 void THTS::visitChanceNode(SearchNode* node) {
+    addToTrialPath(node, false);
     while (states[stepsToGoInNextState]
                .probabilisticStateFluentAsPD(chanceNodeVarIndex)
                .isDeterministic()) {
         ++chanceNodeVarIndex;
     }
 
-    chosenOutcome = outcomeSelection->selectOutcome(
-        node, states[stepsToGoInNextState], chanceNodeVarIndex,
-        lastProbabilisticVarIndex);
+    {
+        std::lock_guard<SearchNode> nodeLock(*node);
+        DiscretePD const& pd = states[stepsToGoInNextState]
+                                   .probabilisticStateFluentAsPD(
+                                       chanceNodeVarIndex);
+        if (solvedNodesMightBeUnlabeled() && allOutcomesSolved(node, pd)) {
+            // Other threads (or trials through a transposition) have solved
+            // all outcomes, but not yet labeled this node as solved
+            if (!tipNodeOfTrial) {
+                tipNodeOfTrial = node;
+            }
+            trialReward = node->getExpectedFutureRewardEstimate();
+            backupFunction->backupChanceNode(node, trialReward);
+            return;
+        }
+        bool isLeaf = node->children.empty();
+        chosenOutcome = outcomeSelection->selectOutcome(
+            node, states[stepsToGoInNextState], chanceNodeVarIndex,
+            lastProbabilisticVarIndex);
+        if (isLeaf && !node->children.empty()) {
+            countChildrenMemory(node);
+        }
+
+        if (!chosenOutcome) {
+            // The memory budget is exhausted and the outcome is not part of
+            // the tree, so the trial ends here and only updates the
+            // statistics of the existing nodes
+            assert(memoryExhausted);
+            endTrialInChanceNode(node);
+            return;
+        }
+    }
 
     if (chanceNodeVarIndex == lastProbabilisticVarIndex) {
         State::calcStateFluentHashKeys(states[stepsToGoInNextState]);
@@ -542,20 +1139,156 @@ void THTS::visitChanceNode(SearchNode* node) {
         ++chanceNodeVarIndex;
         visitChanceNode(chosenOutcome);
     }
+    if (trialDeferred) {
+        return;
+    }
+
+    std::lock_guard<SearchNode> nodeLock(*node);
     backupFunction->backupChanceNode(node, trialReward);
 }
 
+void THTS::visitJointChanceNode(SearchNode* node) {
+    // Sample the values of all probabilistic variables at once (the outcome
+    // selection is not used, and solved outcomes are not excluded)
+    addToTrialPath(node, false);
+    PDState& next = states[stepsToGoInNextState];
+    double prob = 1.0;
+    for (int i = 0; i <= lastProbabilisticVarIndex; ++i) {
+        if (!next.probabilisticStateFluentAsPD(i).isDeterministic()) {
+            prob *= next.sample(i).second;
+        }
+    }
+    State::calcStateFluentHashKeys(next);
+    State::calcStateHashKey(next);
+
+    // Joint outcomes are not used in shared trees, so the node is not locked
+    SearchNode* child = nullptr;
+    std::unordered_map<long, SearchNode*>& outcomes = jointOutcomes[node];
+    std::unordered_map<long, SearchNode*>::const_iterator it =
+        outcomes.find(next.hashKey);
+    if (it != outcomes.end()) {
+        child = it->second;
+    } else if (memoryExhausted) {
+        endTrialInChanceNode(node);
+        return;
+    } else {
+        size_t capacity = node->children.capacity();
+        child = createDecisionNode(prob);
+        node->children.push_back(child);
+        outcomes[next.hashKey] = child;
+        childrenMemory +=
+            (node->children.capacity() - capacity) * sizeof(SearchNode*) +
+            jointOutcomeMemory;
+    }
+
+    if (child->solved) {
+        // The trial ends in a solved outcome, as its value is known
+        if (!tipNodeOfTrial) {
+            tipNodeOfTrial = node;
+        }
+        trialReward = child->getExpectedRewardEstimate();
+    } else {
+        visitDecisionNode(child);
+        if (trialDeferred) {
+            return;
+        }
+    }
+
+    backupFunction->backupChanceNode(node, trialReward);
+}
+
+bool THTS::hasUnsolvedChild(SearchNode const* node) const {
+    for (SearchNode const* child : node->children) {
+        if (child && child->initialized && !child->solved) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool THTS::allOutcomesSolved(SearchNode const* node,
+                             DiscretePD const& pd) const {
+    if (node->children.empty()) {
+        return false;
+    }
+    for (double const& value : pd.values) {
+        SearchNode const* child = node->children[static_cast<int>(value)];
+        if (!child || !child->solved) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool THTS::initializeFromTransposition(SearchNode* node) {
+    State const& current = states[stepsToGoInCurrentState];
+    std::unordered_map<long, SearchNode*> const& table =
+        transpositionTable[stepsToGoInCurrentState];
+    std::unordered_map<long, SearchNode*>::const_iterator it =
+        table.find(current.hashKey);
+    if (it == table.end()) {
+        return false;
+    }
+
+    // The children of an initialized decision node never change, and all
+    // statistics below them are independent of the path to the state
+    SearchNode const* transposition = it->second;
+    assert(transposition != node);
+    assert(transposition->initialized);
+    node->children = transposition->children;
+    node->futureReward = transposition->getExpectedFutureRewardEstimate();
+    node->numberOfVisits = transposition->numberOfVisits.load();
+    node->solved = transposition->solved.load();
+    node->initialized = true;
+
+    ++transpositions;
+    return true;
+}
+
+void THTS::endTrialInChanceNode(SearchNode* node) {
+    if (!tipNodeOfTrial) {
+        tipNodeOfTrial = node;
+    }
+    // Only the value of the action node is meaningful for all backup
+    // functions (e.g., Monte-Carlo backups only approximate the value of the
+    // chance nodes that correspond to single variables)
+    trialReward = appliedActionNode->getExpectedFutureRewardEstimate();
+
+    // A node without children keeps its (initial) value, as backup functions
+    // that compute the value from the children would not be well-defined
+    if (node->children.empty()) {
+        ++node->numberOfVisits;
+    } else {
+        backupFunction->backupChanceNode(node, trialReward);
+    }
+}
+
 void THTS::visitDummyChanceNode(SearchNode* node) {
+    addToTrialPath(node, false);
     State::calcStateFluentHashKeys(states[stepsToGoInNextState]);
     State::calcStateHashKey(states[stepsToGoInNextState]);
 
-    if (node->children.empty()) {
-        node->children.resize(1, nullptr);
-        node->children[0] = createDecisionNode(1.0);
+    SearchNode* child = nullptr;
+    {
+        std::lock_guard<SearchNode> nodeLock(*node);
+        if (node->children.empty() && memoryExhausted) {
+            endTrialInChanceNode(node);
+            return;
+        } else if (node->children.empty()) {
+            node->children.resize(1, nullptr);
+            node->children[0] = createDecisionNode(1.0);
+            countChildrenMemory(node);
+        }
+        assert(node->children.size() == 1);
+        child = node->children[0];
+    }
+
+    visitDecisionNode(child);
+    if (trialDeferred) {
+        return;
     }
-    assert(node->children.size() == 1);
 
-    visitDecisionNode(node->children[0]);
+    std::lock_guard<SearchNode> nodeLock(*node);
     backupFunction->backupChanceNode(node, trialReward);
 }
 
@@ -578,70 +1311,204 @@ int THTS::getUniquePolicy() {
         return applicableActionIndices[0];
     }
 
+    // The state has been solved in an earlier search
+    int solvedPolicyActionIndex = -1;
+    if (lookUpSolvedPolicy(states[stepsToGoInCurrentState],
+                           solvedPolicyActionIndex)) {
+        uniquePolicyDueToSolvedState = true;
+        return solvedPolicyActionIndex;
+    }
+
     // There is no clear, unique policy
     return -1;
 }
 
-SearchNode* THTS::createRootNode() {
-    for (SearchNode* node : nodePool) {
-        if (node) {
-            if (!node->children.empty()) {
-                std::vector<SearchNode*> tmp;
-                node->children.swap(tmp);
+/******************************************************************
+                          Tree reuse
+******************************************************************/
+
+SearchNode* THTS::findReusableSubtree(State const& current) const {
+    // The subtree can only be reused if the last step's tree was not cut off
+    // by the maximal search depth, as the subtree would be too shallow
+    // otherwise
+    if (!reuseTree || !currentRootNode || (lastExecutedActionIndex < 0) ||
+        (current.stepsToGo() != maxSearchDepthForThisStep - 1) ||
+        currentRootNode->children.empty()) {
+        return nullptr;
+    }
+
+    SearchNode* node = currentRootNode->children[lastExecutedActionIndex];
+    if (!node) {
+        return nullptr;
+    }
+
+    // Follow the chance nodes that correspond to the observed outcome
+    PDState next(maxSearchDepthForThisStep - 1);
+    calcSuccessorState(states[maxSearchDepthForThisStep],
+                       lastExecutedActionIndex, next);
+
+    for (int i = 0; i < State::numberOfDeterministicStateFluents; ++i) {
+        if (!MathUtils::doubleIsEqual(next.deterministicStateFluent(i),
+                                      current.deterministicStateFluent(i))) {
+            return nullptr;
+        }
+    }
+
+    bool hasProbabilisticOutcome = false;
+    for (int i = 0; i < State::numberOfProbabilisticStateFluents; ++i) {
+        DiscretePD const& pd = next.probabilisticStateFluentAsPD(i);
+        int value = static_cast<int>(current.probabilisticStateFluent(i));
+        if (pd.isDeterministic()) {
+            if (!MathUtils::doubleIsEqual(pd.values[0], value)) {
+                return nullptr;
             }
+        } else if (useJointOutcomes) {
+            // The outcome is looked up below
+            hasProbabilisticOutcome = true;
         } else {
-            break;
+            if ((value >= static_cast<int>(node->children.size())) ||
+                !node->children[value]) {
+                return nullptr;
+            }
+            node = node->children[value];
+            hasProbabilisticOutcome = true;
         }
     }
 
-    SearchNode* res = nodePool[0];
-
-    if (res) {
-        res->reset(1.0, stepsToGoInCurrentState);
-    } else {
-        res = new SearchNode(1.0, stepsToGoInCurrentState);
-        nodePool[0] = res;
+    // Without probabilistic outcome, the action node is a dummy chance node
+    if (!hasProbabilisticOutcome) {
+        if (node->children.empty()) {
+            return nullptr;
+        }
+        node = node->children[0];
+    } else if (useJointOutcomes) {
+        auto outcomes = jointOutcomes.find(node);
+        if (outcomes == jointOutcomes.end()) {
+            return nullptr;
+        }
+        auto it = outcomes->second.find(current.hashKey);
+        if (it == outcomes->second.end()) {
+            return nullptr;
+        }
+        node = it->second;
     }
-    res->immediateReward = 0.0;
 
-    lastUsedNodePoolIndex = 1;
-    return res;
+    // A decision node that was never expanded (e.g., because its state was
+    // solved before) contains no information that is worth reusing
+    if (!node->initialized || node->children.empty()) {
+        return nullptr;
+    }
+    assert(node->stepsToGo == current.stepsToGo());
+    return node;
 }
 
-SearchNode* THTS::createDecisionNode(double const& prob) {
-    assert(lastUsedNodePoolIndex < nodePool.size());
+void THTS::reuseSubtree(SearchNode* newRoot) {
+    // Move the nodes of the subtree to the front of the node pool (in depth
+    // first order), such that they are not overwritten by new nodes. If
+    // transpositions are used, nodes can be reached on several paths.
+    std::vector<SearchNode*> keptNodes;
+    std::unordered_set<SearchNode*> kept;
+    std::vector<SearchNode*> open(1, newRoot);
+    while (!open.empty()) {
+        SearchNode* node = open.back();
+        open.pop_back();
+        if (!kept.insert(node).second) {
+            continue;
+        }
+        keptNodes.push_back(node);
+        for (SearchNode* child : node->children) {
+            if (child) {
+                open.push_back(child);
+            }
+        }
+    }
 
-    SearchNode* res = nodePool[lastUsedNodePoolIndex];
+    for (int i = 0; i < lastUsedNodePoolIndex; ++i) {
+        SearchNode* node = nodePool[i];
+        if (kept.find(node) == kept.end()) {
+            // Free the memory of the children of pruned nodes
+            std::vector<SearchNode*> tmp;
+            node->children.swap(tmp);
+            keptNodes.push_back(node);
+        }
+    }
+    assert(static_cast<int>(keptNodes.size()) == lastUsedNodePoolIndex);
+    std::copy(keptNodes.begin(), keptNodes.end(), nodePool.begin());
+
+    newRoot->prob = 1.0;
+    newRoot->immediateReward = 0.0;
+    reusedNodes = kept.size();
+    lastUsedNodePoolIndex = reusedNodes;
+    childrenMemory = 0;
+    for (int i = 0; i < lastUsedNodePoolIndex; ++i) {
+        countChildrenMemory(nodePool[i]);
+    }
 
-    if (res) {
-        res->reset(prob, stepsToGoInNextState);
-    } else {
-        res = new SearchNode(prob, stepsToGoInNextState);
-        nodePool[lastUsedNodePoolIndex] = res;
+    // The kept nodes are not registered as transpositions again, as their
+    // states are unknown
+    for (std::unordered_map<long, SearchNode*>& table : transpositionTable) {
+        table.clear();
     }
-    calcReward(states[stepsToGoInCurrentState], appliedActionIndex,
-               res->immediateReward);
 
+    // The joint outcomes of pruned action nodes are removed
+    for (auto it = jointOutcomes.begin(); it != jointOutcomes.end();) {
+        if (kept.find(it->first) == kept.end()) {
+            it = jointOutcomes.erase(it);
+        } else {
+            childrenMemory += it->second.size() * jointOutcomeMemory;
+            ++it;
+        }
+    }
+}
+
+SearchNode* THTS::getUnusedNode(double const& prob, int const& stepsToGo) {
+    if (lastUsedNodePoolIndex == static_cast<int>(nodePool.size())) {
+        // Search nodes are never deleted, but reset when they are reused
+        SearchNode* block = new SearchNode[nodeBlockSize];
+        nodePool.reserve(nodePool.size() + nodeBlockSize);
+        for (int i = 0; i < nodeBlockSize; ++i) {
+            nodePool.push_back(block + i);
+        }
+    }
+
+    SearchNode* res = nodePool[lastUsedNodePoolIndex];
+    res->reset(prob, stepsToGo);
     ++lastUsedNodePoolIndex;
     return res;
 }
 
-SearchNode* THTS::createChanceNode(double const& prob) {
-    assert(lastUsedNodePoolIndex < nodePool.size());
+SearchNode* THTS::createRootNode() {
+    // Nodes that have not been used in the last step have been cleared before
+    for (int i = 0; i < lastUsedNodePoolIndex; ++i) {
+        SearchNode* node = nodePool[i];
+        if (!node->children.empty()) {
+            std::vector<SearchNode*> tmp;
+            node->children.swap(tmp);
+        }
+    }
 
-    SearchNode* res = nodePool[lastUsedNodePoolIndex];
+    lastUsedNodePoolIndex = 0;
+    childrenMemory = 0;
+    SearchNode* res = getUnusedNode(1.0, stepsToGoInCurrentState);
 
-    if (res) {
-        res->reset(prob, stepsToGoInCurrentState);
-    } else {
-        res = new SearchNode(prob, stepsToGoInCurrentState);
-        nodePool[lastUsedNodePoolIndex] = res;
+    for (std::unordered_map<long, SearchNode*>& table : transpositionTable) {
+        table.clear();
     }
+    jointOutcomes.clear();
+    return res;
+}
 
-    ++lastUsedNodePoolIndex;
+SearchNode* THTS::createDecisionNode(double const& prob) {
+    SearchNode* res = getUnusedNode(prob, stepsToGoInNextState);
+    calcReward(states[stepsToGoInCurrentState], appliedActionIndex,
+               res->immediateReward);
     return res;
 }
 
+SearchNode* THTS::createChanceNode(double const& prob) {
+    return getUnusedNode(prob, stepsToGoInCurrentState);
+}
+
 void THTS::setMaxSearchDepth(int _maxSearchDepth) {
     SearchEngine::setMaxSearchDepth(_maxSearchDepth);
 
@@ -649,6 +1516,14 @@ void THTS::setMaxSearchDepth(int _maxSearchDepth) {
     initializer->setMaxSearchDepth(_maxSearchDepth);
 }
 
+void THTS::setTimeout(double _timeout) {
+    SearchEngine::setTimeout(_timeout);
+
+    for (THTS* worker : workers) {
+        worker->setTimeout(_timeout);
+    }
+}
+
 void THTS::printConfig(std::string indent) const {
     SearchEngine::printConfig(indent);
     indent += "  ";
@@ -682,9 +1557,51 @@ void THTS::printConfig(std::string indent) const {
     Logger::logLine(
         indent + "Max num search nodes: " + std::to_string(maxNumberOfNodes),
         Verbosity::VERBOSE);
+    if (maxTreeMemory < std::numeric_limits<long>::max()) {
+        Logger::logLine(indent + "Max tree memory (KB): " +
+                            std::to_string(maxTreeMemory / 1024),
+                        Verbosity::VERBOSE);
+    }
+    if (stabilityThreshold > 0.0) {
+        Logger::logLine(indent + "Stability threshold: " +
+                            std::to_string(stabilityThreshold),
+                        Verbosity::VERBOSE);
+    }
+    Logger::logLine(
+        indent + "Node block size: " + std::to_string(nodeBlockSize),
+        Verbosity::VERBOSE);
+    Logger::logLine(
+        indent + "Number of threads: " + std::to_string(numberOfThreads),
+        Verbosity::VERBOSE);
+    if (numberOfThreads > 1) {
+        if (useSharedTree) {
+            Logger::logLine(indent + "Parallelization: shared tree",
+                            Verbosity::VERBOSE);
+        } else {
+            Logger::logLine(indent + "Parallelization: one tree per thread",
+                            Verbosity::VERBOSE);
+        }
+    }
+    if (useTranspositions) {
+        Logger::logLine(indent + "Transpositions: enabled", Verbosity::VERBOSE);
+    } else {
+        Logger::logLine(indent + "Transpositions: disabled",
+                        Verbosity::VERBOSE);
+    }
+    if (useJointOutcomes) {
+        Logger::logLine(indent + "Outcomes: joint", Verbosity::VERBOSE);
+    } else {
+        Logger::logLine(indent + "Outcomes: one chance node per variable",
+                        Verbosity::VERBOSE);
+    }
     Logger::logLine(
-        indent + "Node pool size: " + std::to_string(nodePool.size()),
+        indent + "Batch size of initializations: " + std::to_string(batchSize),
         Verbosity::VERBOSE);
+    if (reuseTree) {
+        Logger::logLine(indent + "Tree reuse: enabled", Verbosity::VERBOSE);
+    } else {
+        Logger::logLine(indent + "Tree reuse: disabled", Verbosity::VERBOSE);
+    }
 
     actionSelection->printConfig(indent);
     outcomeSelection->printConfig(indent);
@@ -712,6 +1629,10 @@ void THTS::printStepStatistics(std::string indent) const {
         Logger::logLine(
             indent + "Policy unique due to single reasonable action",
             Verbosity::NORMAL);
+    } else if (uniquePolicyDueToSolvedState) {
+        Logger::logLine(
+            indent + "Policy unique due to cached solved state",
+            Verbosity::NORMAL);
     } else {
         Logger::logLine(
             indent + name + " step statistics:", Verbosity::NORMAL);
@@ -723,13 +1644,51 @@ void THTS::printStepStatistics(std::string indent) const {
         Logger::logLine(
             indent + "Performed trials: " + std::to_string(currentTrial),
             Verbosity::NORMAL);
+        if (!workers.empty()) {
+            int numberOfTrials = currentTrial;
+            for (THTS const* worker : workers) {
+                numberOfTrials += worker->currentTrial;
+            }
+            Logger::logLine(
+                indent + "Performed trials in all threads: " +
+                std::to_string(numberOfTrials),
+                Verbosity::NORMAL);
+        }
         Logger::logLine(
             indent + "Created search nodes: " +
             std::to_string(lastUsedNodePoolIndex),
             Verbosity::NORMAL);
+        if (reuseTree) {
+            Logger::logLine(
+                indent + "Reused search nodes: " + std::to_string(reusedNodes),
+                Verbosity::NORMAL);
+        }
+        Logger::logLine(
+            indent + "Tree memory (KB): " +
+            std::to_string(getTreeMemory() / 1024),
+            Verbosity::VERBOSE);
+        if (memoryExhausted) {
+            Logger::logLine(indent + "Tree memory budget reached",
+                            Verbosity::NORMAL);
+        }
+        if (useTranspositions) {
+            Logger::logLine(
+                indent + "Transpositions: " + std::to_string(transpositions),
+                Verbosity::NORMAL);
+        }
+        if (batchInitializations()) {
+            Logger::logLine(indent + "Batched initializations: " +
+                                std::to_string(batchedInitializations),
+                            Verbosity::NORMAL);
+        }
         Logger::logLine(
             indent + "Search time: " + std::to_string(lastSearchTime),
             Verbosity::NORMAL);
+        if (terminatedEarly) {
+            Logger::logLine(indent + "Terminated early as recommendation is "
+                                     "stable",
+                            Verbosity::NORMAL);
+        }
         Logger::logLine(
             indent + "Cache hits: " + std::to_string(cacheHits),
             Verbosity::VERBOSE);
@@ -798,6 +1757,14 @@ void THTS::printRoundStatistics(std::string indent) const {
         indent + "Number of states with only one applicable action: " +
         std::to_string(numSingleApplicableActionStates),
         Verbosity::NORMAL);
+    Logger::logLine(
+        indent + "Number of states with cached solved policy: " +
+        std::to_string(numSolvedPolicyStates),
+        Verbosity::NORMAL);
+    Logger::logLine(
+        indent + "Entries in policy cache: " +
+        std::to_string(policyCache.size()),
+        Verbosity::VERBOSE);
 
     Logger::logLine("", Verbosity::VERBOSE);
     actionSelection->printRoundStatistics(indent);
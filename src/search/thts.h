@@ -3,8 +3,14 @@
 
 #include "search_engine.h"
 
+#include "utils/cache_lock.h"
 #include "utils/stopwatch.h"
 
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
 class ActionSelection;
 class OutcomeSelection;
 class BackupFunction;
@@ -32,25 +38,22 @@ class RecommendationFunction;
 
 // Add ingredients by deriving from the corresponding class.
 
-struct SearchNode {
-    SearchNode(double const& _prob, int const& _stepsToGo)
+// Search nodes are aligned to cache lines (the members are ordered such that a
+// node fits into a single line), as they are allocated in blocks of contiguous
+// memory by THTS. A node does not own its children, which are part of these
+// blocks.
+struct alignas(64) SearchNode {
+    SearchNode(double const& _prob = 1.0, int const& _stepsToGo = 0)
         : children(),
           immediateReward(0.0),
           prob(_prob),
-          stepsToGo(_stepsToGo),
           futureReward(-std::numeric_limits<double>::max()),
+          stepsToGo(_stepsToGo),
           numberOfVisits(0),
+          virtualLoss(0),
           initialized(false),
           solved(false) {}
 
-    ~SearchNode() {
-        for (unsigned int i = 0; i < children.size(); ++i) {
-            if (children[i]) {
-                delete children[i];
-            }
-        }
-    }
-
     void reset(double const& _prob, int const& _stepsToGo) {
         children.clear();
         immediateReward = 0.0;
@@ -58,10 +61,28 @@ struct SearchNode {
         stepsToGo = _stepsToGo;
         futureReward = -std::numeric_limits<double>::max();
         numberOfVisits = 0;
+        virtualLoss = 0;
         initialized = false;
         solved = false;
     }
 
+    // If several threads search in the same tree, a node is locked while its
+    // children are created, initialized or backed up. This makes a SearchNode
+    // usable with std::lock_guard.
+    void lock() {
+        if (CacheLock::parallelSearch) {
+            while (busy.test_and_set(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void unlock() {
+        if (CacheLock::parallelSearch) {
+            busy.clear(std::memory_order_release);
+        }
+    }
+
     double getExpectedRewardEstimate() const {
         return immediateReward + futureReward;
     }
@@ -76,19 +97,27 @@ struct SearchNode {
 
     double immediateReward;
     double prob;
+
+    // The statistics that are updated in backups are atomic, since they are
+    // read without locking the node if several threads search in the same tree
+    std::atomic<double> futureReward;
     int stepsToGo;
+    std::atomic<int> numberOfVisits;
 
-    double futureReward;
-    int numberOfVisits;
+    // The number of threads that currently perform a trial below this node
+    std::atomic<int> virtualLoss;
 
     // This is used in two ways: in decision nodes, it is true if all children
     // are initialized; and in chance nodes that represent an action (i.e., in
     // children of decision nodes), it is true if an initial value has been
     // assigned to the node.
-    bool initialized;
+    std::atomic<bool> initialized;
 
     // A node is solved if futureReward is equal to the true future reward
-    bool solved;
+    std::atomic<bool> solved;
+
+private:
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
 };
 
 class THTS : public ProbabilisticSearchEngine {
@@ -119,6 +148,9 @@ public:
     void initStep(State const& current) override;
     void finishStep() override;
 
+    // Remember the executed action to reuse the according subtree
+    void setExecutedAction(int actionIndex) override;
+
     // Start the search engine as main search engine
     void estimateBestActions(State const& _rootState,
                              std::vector<int>& bestActions) override;
@@ -146,6 +178,7 @@ public:
         RecommendationFunction* _recommendationFunction);
 
     void setMaxSearchDepth(int _maxSearchDepth) override;
+    void setTimeout(double _timeout) override;
     void setTerminationMethod(THTS::TerminationMethod _terminationMethod) {
         terminationMethod = _terminationMethod;
     }
@@ -161,10 +194,38 @@ public:
 
     void setMaxNumberOfNodes(int _maxNumberOfNodes) {
         maxNumberOfNodes = _maxNumberOfNodes;
-        // Resize the node pool and give it a "safety net" of 20000 nodes (this
-        // is because the termination criterion is checked only at the root and
-        // not in the middle of a trial)
-        nodePool.resize(maxNumberOfNodes + 20000, nullptr);
+    }
+
+    void setMaxTreeMemory(long _maxTreeMemory) {
+        maxTreeMemory = _maxTreeMemory;
+    }
+
+    void setStabilityThreshold(double _stabilityThreshold) {
+        stabilityThreshold = _stabilityThreshold;
+    }
+
+    void setNumberOfThreads(int _numberOfThreads) {
+        numberOfThreads = _numberOfThreads;
+    }
+
+    void setUseSharedTree(bool _useSharedTree) {
+        useSharedTree = _useSharedTree;
+    }
+
+    void setReuseTree(bool _reuseTree) {
+        reuseTree = _reuseTree;
+    }
+
+    void setUseTranspositions(bool _useTranspositions) {
+        useTranspositions = _useTranspositions;
+    }
+
+    void setUseJointOutcomes(bool _useJointOutcomes) {
+        useJointOutcomes = _useJointOutcomes;
+    }
+
+    void setBatchSize(int _batchSize) {
+        batchSize = _batchSize;
     }
 
     // Methods to create search nodes
@@ -181,6 +242,12 @@ public:
         return tipNodeOfTrial;
     }
 
+    // If the tree has reached its memory budget, trials do not create new
+    // nodes but end in the first node where they would
+    bool treeMemoryExhausted() const {
+        return memoryExhausted;
+    }
+
     // Print
     void printConfig(std::string indent) const override;
     void printRoundStatistics(std::string indent) const override;
@@ -191,6 +258,24 @@ private:
     void visitDecisionNode(SearchNode* node);
     void visitChanceNode(SearchNode* node);
     void visitDummyChanceNode(SearchNode* node);
+    void visitJointChanceNode(SearchNode* node);
+
+    // Ends the trial in a chance node if it would create a new node although
+    // the memory budget is exhausted
+    void endTrialInChanceNode(SearchNode* node);
+
+    // Used to detect nodes that have been solved by other threads or via
+    // another path to a transposition
+    bool hasUnsolvedChild(SearchNode const* node) const;
+    bool allOutcomesSolved(SearchNode const* node, DiscretePD const& pd) const;
+    bool solvedNodesMightBeUnlabeled() const {
+        return CacheLock::parallelSearch || useTranspositions;
+    }
+
+    // If the current state has already been initialized with the same
+    // steps-to-go, node shares the action nodes of that decision node instead
+    // of being initialized again. Returns false if there is no such node.
+    bool initializeFromTransposition(SearchNode* node);
 
     void initTrial();
     void initTrialStep();
@@ -202,14 +287,85 @@ private:
 
     // Determines if the current state has been solved before
     bool currentStateIsSolved(SearchNode* node);
+    bool lookUpSolvedState(State const& state, double& value);
+
+    // Stores the value and the optimal action of the state of a node that has
+    // been labeled as solved, and looks up the optimal action of a state
+    void cacheSolvedState(SearchNode const* node, State const& state);
+    bool lookUpSolvedPolicy(State const& state, int& actionIndex);
 
     // If the root state is a reward lock or has only one reasonable action,
     // noop or the only reasonable action is returned
     int getUniquePolicy();
 
+    // Is true if the action with the highest estimate in the root node has
+    // been selected in at least a stabilityThreshold share of all visits. The
+    // search terminates early in this case (if the threshold is positive), as
+    // the recommendation is unlikely to change.
+    bool recommendationIsStable() const;
+    static int const stabilityCheckInterval = 100;
+
     // Determine if another trial is performed
     bool moreTrials();
 
+    // Performs trials until some termination criterion is fulfilled
+    void performTrials();
+
+    // If initializations are batched, trials end in the first node that must
+    // be initialized. Once batchSize such trials have been performed, the
+    // nodes are initialized simultaneously by this search engine and the
+    // workers, and the deferred backups of the trials are performed.
+    struct PendingInitialization {
+        SearchNode* node;
+        State state;
+        // The nodes that have been visited in the trial (the flag is true for
+        // decision nodes)
+        std::vector<std::pair<SearchNode*, bool>> path;
+    };
+    void performBatchedTrials();
+    void deferInitialization(SearchNode* node);
+    void initializeBatch();
+    void completeBatchedTrials();
+    bool batchInitializations() const {
+        return batchSize > 1;
+    }
+    bool useVirtualLoss() const {
+        return CacheLock::parallelSearch || batchInitializations();
+    }
+    void addToTrialPath(SearchNode* node, bool isDecisionNode) {
+        if (batchInitializations()) {
+            trialPath.emplace_back(node, isDecisionNode);
+        }
+    }
+
+    // Performs trials in this tree and in the trees of all workers
+    // simultaneously, and recommends based on the combined root nodes
+    void performTrialsInParallel();
+    void recommendFromAllTrees(std::vector<int>& bestActions);
+
+    // Tree reuse: returns the decision node of the last step's tree that
+    // corresponds to the outcome of the executed action (or nullptr if there
+    // is none), and moves the subtree of that node to the front of the node
+    // pool such that all other nodes can be overwritten
+    SearchNode* findReusableSubtree(State const& current) const;
+    void reuseSubtree(SearchNode* newRoot);
+
+    // Returns the next node of the node pool (which is allocated if necessary)
+    SearchNode* getUnusedNode(double const& prob, int const& stepsToGo);
+
+    // Memory that is used by the search nodes and their children (in bytes).
+    // Must be called when a node has been expanded to count its children.
+    long getTreeMemory() const {
+        return lastUsedNodePoolIndex *
+                   (sizeof(SearchNode) + sizeof(SearchNode*)) +
+               childrenMemory;
+    }
+    void countChildrenMemory(SearchNode const* node) {
+        childrenMemory += node->children.capacity() * sizeof(SearchNode*);
+    }
+    static size_t const jointOutcomeMemory =
+        sizeof(std::pair<long const, SearchNode*>) + 2 * sizeof(void*);
+
     // Ingredients that are implemented externally
     ActionSelection* actionSelection;
     OutcomeSelection* outcomeSelection;
@@ -233,6 +389,7 @@ private:
     int stepsToGoInCurrentState;
     int stepsToGoInNextState;
     int appliedActionIndex;
+    SearchNode* appliedActionNode;
 
     // The accumulated reward that has been achieved in the current trial (the
     // rewards are accumulated in reverse order during the backup phase, such
@@ -256,9 +413,15 @@ private:
     // the current trial
     int initializedDecisionNodes;
 
-    // Memory management (nodePool)
+    // Memory management (nodePool). Search nodes are allocated in blocks of
+    // nodeBlockSize nodes once they are needed (the node limit is only checked
+    // at the root, so a trial may exceed it), and the node pool contains
+    // pointers to all allocated nodes in the order in which they are used.
+    static int const nodeBlockSize = 4096;
     int lastUsedNodePoolIndex;
     std::vector<SearchNode*> nodePool;
+    long childrenMemory;
+    bool memoryExhausted;
 
     // The stopwatch used for timeout check
     Stopwatch stopwatch;
@@ -268,13 +431,69 @@ private:
     int maxNumberOfTrials;
     int numberOfNewDecisionNodesPerTrial;
     int maxNumberOfNodes;
+    long maxTreeMemory;
+    double stabilityThreshold;
+    int numberOfThreads;
+    bool useSharedTree;
+    bool reuseTree;
+    bool useTranspositions;
+    bool useJointOutcomes;
+    int batchSize;
+
+    // Every worker performs trials in a separate thread, either in its own tree
+    // (root parallelization) or in the tree of this search engine (tree
+    // parallelization). The workers are created in initSession from the
+    // parameters this search engine was created with.
+    std::vector<THTS*> workers;
+    std::vector<std::pair<std::string, std::string>> parameters;
+
+    // If this is a worker that searches in the tree of another search engine,
+    // this is the search engine that owns the root node
+    THTS const* sharedTreeOwner;
+
+    // Transposition table that maps the hash key of a state to the first
+    // initialized decision node of that state (separately for each number of
+    // steps-to-go). All decision nodes of the same state share their children.
+    std::vector<std::unordered_map<long, SearchNode*>> transpositionTable;
+
+    // If joint outcomes are used, the outcomes of an action are not
+    // represented by a chain of chance nodes (one per probabilistic variable),
+    // but all children of an action node are decision nodes, which are
+    // identified by the hash key of their state
+    std::unordered_map<SearchNode*, std::unordered_map<long, SearchNode*>>
+        jointOutcomes;
+
+    // The path of the current trial, the trials that wait for the
+    // initialization of their last node, and a flag that is true while the
+    // current trial is unwound because it has been deferred
+    std::vector<std::pair<SearchNode*, bool>> trialPath;
+    std::vector<PendingInitialization> pendingInitializations;
+    bool trialDeferred;
+
+    // The action that has been executed in the last step (or -1 if no action
+    // has been executed in the current round)
+    int lastExecutedActionIndex;
+
+    // Cache for the optimal action in solved states. Like the state value
+    // cache, it is kept across steps and rounds, such that the policy in a
+    // state that has been solved before is known without search. It is
+    // released when caching is disabled.
+    typedef std::unordered_map<State, int, State::HashWithRemSteps,
+                               State::EqualWithRemSteps>
+        PolicyHashMap;
+    static PolicyHashMap policyCache;
 
     // Per step statistics
     int cacheHits;
+    int reusedNodes;
+    int transpositions;
+    int batchedInitializations;
+    bool terminatedEarly;
     double lastSearchTime;
     bool uniquePolicyDueToLastAction;
     bool uniquePolicyDueToRewardLock;
     bool uniquePolicyDueToPreconds;
+    bool uniquePolicyDueToSolvedState;
 
     // Per round statistics
     int stepsToGoInFirstSolvedState;
@@ -283,6 +502,7 @@ private:
     int numSearchNodesInFirstRelevantState;
     int numRewardLockStates;
     int numSingleApplicableActionStates;
+    int numSolvedPolicyStates;
 };
 
 #endif
@@ -0,0 +1,3 @@
+#include "cache_lock.h"
+
+bool CacheLock::parallelSearch = false;
@@ -0,0 +1,36 @@
+#ifndef CACHE_LOCK_H
+#define CACHE_LOCK_H
+
+#include <mutex>
+
+// Locks a mutex for the lifetime of the object, but only if the search is
+// currently performed by several threads. This is used to protect caches that
+// are shared by all threads (e.g., the caches of evaluatables or of state
+// values) without slowing down the single-threaded search.
+class CacheLock {
+public:
+    explicit CacheLock(std::mutex& _mutex)
+        : mutex(parallelSearch ? &_mutex : nullptr) {
+        if (mutex) {
+            mutex->lock();
+        }
+    }
+
+    ~CacheLock() {
+        if (mutex) {
+            mutex->unlock();
+        }
+    }
+
+    CacheLock(CacheLock const&) = delete;
+    CacheLock& operator=(CacheLock const&) = delete;
+
+    // Is true while several threads search in parallel. This must only be
+    // changed while no other thread is running.
+    static bool parallelSearch;
+
+private:
+    std::mutex* mutex;
+};
+
+#endif
@@ -1,5 +1,5 @@
 #include "math_utils.h"
-std::unique_ptr<Random<>> MathUtils::rnd{new RandomMT()};
+thread_local std::unique_ptr<Random<>> MathUtils::rnd{new RandomMT()};
 
 void MathUtils::resetRNG() {
     rnd.reset(new RandomMT());
@@ -62,8 +62,8 @@ public:
     // Reset the random number generator
     static void resetRNG();
 
-    // Random number generator
-    static std::unique_ptr<Random<>> rnd;
+    // Random number generator (each thread uses its own generator)
+    static thread_local std::unique_ptr<Random<>> rnd;
 
 private:
     MathUtils() {}
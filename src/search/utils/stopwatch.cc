@@ -1,5 +1,7 @@
 #include "stopwatch.h"
 
+#include <ctime>
+
 using namespace std::chrono;
 
 void Stopwatch::reset() {
@@ -11,6 +13,21 @@ double Stopwatch::operator()() const {
     return time_span.count();
 }
 
+void ThreadStopwatch::reset() {
+    startTime = now();
+}
+
+double ThreadStopwatch::operator()() const {
+    return now() - startTime;
+}
+
+double ThreadStopwatch::now() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<double>(time.tv_sec) +
+           static_cast<double>(time.tv_nsec) / 1e9;
+}
+
 std::ostream& operator<<(std::ostream& os, Stopwatch const& stopwatch) {
     os << stopwatch() << "s";
     return os;
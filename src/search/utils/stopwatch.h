@@ -18,6 +18,23 @@ private:
     std::chrono::steady_clock::time_point startTime;
 };
 
+// Measure the CPU time the calling thread spent since construction/reset. In
+// contrast to the elapsed time, this is not affected by other threads that run
+// simultaneously (unless they compete for a core).
+class ThreadStopwatch {
+public:
+    ThreadStopwatch() : startTime(now()) {}
+
+    void reset();
+    // Returns the CPU time of the calling thread since start
+    double operator()() const;
+
+private:
+    static double now();
+
+    double startTime;
+};
+
 // Convenience operator to stream elapsed time with seconds as unit
 std::ostream& operator<<(std::ostream& os, Stopwatch const& stopwatch);
 